@@ -0,0 +1,45 @@
+// Minimal Arduino.h stand-in for building ILI9486_Display on a desktop host
+// together with ILI9486_HostBus. Only what the library uses is provided.
+#ifndef ILI9486_HOST_ARDUINO_H
+#define ILI9486_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define PROGMEM
+#define HIGH      1
+#define LOW       0
+#define INPUT     0
+#define OUTPUT    1
+#define MSBFIRST  1
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define memcpy_P            memcpy
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void delay(unsigned long) {}
+
+inline char *itoa(int value, char *buf, int) { sprintf(buf, "%d", value); return buf; }
+inline char *ultoa(unsigned long value, char *buf, int) { sprintf(buf, "%lu", value); return buf; }
+inline char *dtostrf(double value, signed char width, unsigned char prec, char *buf) {
+  sprintf(buf, "%*.*f", width, prec, value);
+  return buf;
+}
+
+class String {
+public:
+  String(const char *str = "") : _s(str ? str : "") {}
+  unsigned int length() const { return _s.size(); }
+  char operator[](unsigned int i) const { return _s[i]; }
+  const char *c_str() const { return _s.c_str(); }
+private:
+  std::string _s;
+};
+
+#endif // ILI9486_HOST_ARDUINO_H
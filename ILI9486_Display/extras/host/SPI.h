@@ -0,0 +1,26 @@
+// Minimal SPI.h stand-in for desktop host builds. The SPI object does
+// nothing; use ILI9486_HostBus to capture what the driver sends.
+#ifndef ILI9486_HOST_SPI_H
+#define ILI9486_HOST_SPI_H
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0
+
+class SPISettings {
+public:
+  SPISettings(uint32_t = 0, uint8_t = MSBFIRST, uint8_t = SPI_MODE0) {}
+};
+
+class SPIClass {
+public:
+  void begin(int8_t = -1, int8_t = -1, int8_t = -1, int8_t = -1) {}
+  void beginTransaction(SPISettings) {}
+  void endTransaction() {}
+  uint8_t transfer(uint8_t) { return 0; }
+  void writeBytes(const uint8_t *, uint32_t) {}
+};
+
+static SPIClass SPI;
+
+#endif // ILI9486_HOST_SPI_H
@@ -0,0 +1,55 @@
+// Precompile a static screen into a blob for ILI9486_Driver::pushBlob().
+//
+// The screen is drawn with the normal drawing API into ILI9486_BlobBus and
+// written to stdout as a C array that can be placed in flash:
+//
+//   g++ -std=gnu++17 -Iextras/host -Isrc extras/host/blob_tool.cpp -o blob_tool
+//   ./blob_tool splash_blob 1 > splash_blob.h      (name, rotation)
+//
+// Replace drawScreen() with your own screen. Writing it as a template lets
+// the same function draw live on the device as well.
+#include <Arduino.h>
+#include <ILI9486_Display.h>
+#include <ILI9486_Blob.h>
+
+template <class Display>
+void drawScreen(Display &tft) {
+  tft.fillScreen(TFT_BLACK);
+  tft.fillRect(0, 0, tft.width(), 40, TFT_DARKGREY);
+  tft.setTextColor(TFT_WHITE, TFT_DARKGREY);
+  tft.setTextDatum(MC_DATUM);
+  tft.drawString("ILI9486 Display", tft.width() / 2, 20, 2);
+  tft.drawRect(10, 60, tft.width() - 20, tft.height() - 70, TFT_LIGHTGREY);
+  tft.setTextColor(TFT_ORANGE);
+  tft.setTextDatum(TL_DATUM);
+  tft.drawString("Starting...", 20, 80, 1);
+}
+
+static uint8_t blob[512 * 1024];
+
+int main(int argc, char **argv) {
+  const char *name = argc > 1 ? argv[1] : "screen_blob";
+  uint8_t rotation = argc > 2 ? atoi(argv[2]) : 0;
+
+  ILI9486_Driver<ILI9486_BlobBus> tft((ILI9486_BlobBus(blob, sizeof(blob))));
+  tft.begin();
+  tft.bus().clear();          // Keep only what the screen itself sends
+  tft.invalidateShadow();     // so the blob sets its own window and orientation
+  tft.setRotation(rotation);
+  drawScreen(tft);
+
+  size_t len = tft.bus().finish();
+  if (len == 0) {
+    fprintf(stderr, "blob buffer too small\n");
+    return 1;
+  }
+
+  printf("// Generated by blob_tool - replay with tft.pushBlob(%s)\n", name);
+  printf("static const uint8_t %s[%u] PROGMEM = {", name, (unsigned)len);
+  for (size_t i = 0; i < len; i++) {
+    printf("%s0x%02X,", i % 16 ? " " : "\n  ", blob[i]);
+  }
+  printf("\n};\n");
+  fprintf(stderr, "%s: %u bytes\n", name, (unsigned)len);
+  return 0;
+}
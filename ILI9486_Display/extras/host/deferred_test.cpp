@@ -0,0 +1,106 @@
+// Check the deferred-drawing optimizer against direct drawing. Random UI
+// frames (panels cleared and redrawn, fills split into mergeable halves,
+// shapes, bitmaps and text on top) are drawn once directly and once between
+// beginDeferred() and endDeferred(); the results must match pixel for pixel
+// (read back through the mirror), in both orientations, with a buffer that
+// holds the whole frame and one that fills up and is drawn part way through.
+//
+//   g++ -std=gnu++17 -Iextras/host -Isrc extras/host/deferred_test.cpp -o deferred_test
+//   ./deferred_test
+#include <Arduino.h>
+#include <ILI9486_Display.h>
+#include <ILI9486_HostBus.h>
+#include "../../examples/FontExample/FreeSans9pt7b.h"
+
+typedef ILI9486_Driver<ILI9486_HostBus> Display;
+
+static uint16_t image[40 * 30];
+static const uint8_t bitmap[] = { 0xF0, 0x0F, 0xAA, 0x55, 0x81, 0x18, 0xFF, 0x00 };
+
+static uint32_t seed = 1;
+static int rnd(int n) {
+  seed = seed * 1103515245 + 12345;
+  return (int)((seed >> 8) % (uint32_t)n);
+}
+
+static void frame(Display &tft, int s) {
+  seed = s;
+  for (int panel = 0; panel < 6; panel++) {
+    int x = rnd(400) - 20, y = rnd(300) - 20, w = rnd(200) + 1, h = rnd(150) + 1;
+    tft.fillRect(x, y, w, h, TFT_BLACK);                  // Clear, then redraw
+    tft.fillRect(x, y, w, h, rnd(4) * 0x1111);
+    tft.fillRect(x, y, w, 20, TFT_BLUE);                  // Header in two halves
+    tft.fillRect(x, y + 20, w, 20, TFT_BLUE);
+    tft.fillRect(x + 5, y + 45, w / 2, 10, TFT_RED);
+    tft.fillRect(x + 5 + w / 2, y + 45, w / 2, 10, TFT_RED);
+    for (int k = 0; k < 8; k++) {
+      tft.fillRect(x + rnd(w), y + rnd(h), rnd(40) + 1, rnd(30) + 1, rnd(3) * 0x3333);
+    }
+    tft.drawRect(x, y, w, h, TFT_WHITE);
+    tft.drawLine(x, y, x + w, y + h, TFT_YELLOW);
+    tft.drawCircle(x + w / 2, y + h / 2, rnd(40), TFT_GREEN);
+    tft.fillCircle(x + rnd(w), y + rnd(h), rnd(20), TFT_ORANGE);
+    tft.drawPixel(x + 1, y + 1, TFT_RED);
+    tft.drawBitmap(x + 10, y + 60, bitmap, 16, 4, TFT_CYAN);
+    tft.drawBitmap(x + 30, y + 60, bitmap, 16, 4, TFT_CYAN, TFT_MAGENTA);
+    tft.setFreeFont(nullptr);
+    if (panel & 1) {
+      tft.setTextColor(TFT_WHITE, TFT_BLUE);
+    } else {
+      tft.setTextColor(TFT_YELLOW);
+    }
+    tft.drawString("Label 12", x + 4, y + 4);
+    tft.setFreeFont(&FreeSans9pt7b);
+    tft.drawString("Value", x + 10, y + 25);
+    tft.pushImage(x > 0 ? x : 0, y > 0 ? y : 0, 40, 30, image);
+    for (int r = 0; r < 10; r++) {
+      tft.fillRect(x + 2, y + 70 + r * 6, w - 4, 6, TFT_DARKGREY);   // Stacked rows, one color
+    }
+    if (panel == 3) {
+      // Direct streaming ends the deferred frame first
+      tft.pushRows(x > 0 ? x : 0, y > 0 ? y : 0, 20, 10, [](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+        memcpy(dst, &image[row * 40 + col], count * 2);
+      });
+    }
+  }
+}
+
+int main() {
+  for (int i = 0; i < 40 * 30; i++) image[i] = i * 91;
+  long bad = 0, direct = 0, deferred = 0;
+  for (int rot = 0; rot < 2; rot++) {
+    for (int s = 1; s <= 30; s++) {
+      for (int small = 0; small < 2; small++) {
+        Display a((ILI9486_HostBus())), b((ILI9486_HostBus()));
+        a.begin();
+        b.begin();
+        a.setRotation(rot);
+        b.setRotation(rot);
+        a.beginMirror();
+        b.beginMirror();
+        a.bus().clear();
+        b.bus().clear();
+
+        frame(a, s);
+        b.beginDeferred(small ? 40 : 512);
+        frame(b, s);
+        b.endDeferred();
+
+        long diff = 0;
+        for (int y = 0; y < a.height(); y++) {
+          for (int x = 0; x < a.width(); x++) {
+            if (a.readPixel(x, y) != b.readPixel(x, y)) diff++;
+          }
+        }
+        if (diff && ++bad < 5) {
+          printf("rotation %d seed %d buffer %d: %ld pixels differ\n", rot, s, small ? 40 : 512, diff);
+        }
+        direct += a.bus().stats().totalBytes();
+        deferred += b.bus().stats().totalBytes();
+      }
+    }
+  }
+  bool smaller = deferred < direct;
+  printf("deferred: %ld bad frames, %.1f%% of direct bytes  %s\n", bad, 100.0 * deferred / direct, smaller ? "ok" : "FAIL");
+  return bad || !smaller ? 1 : 0;
+}
@@ -0,0 +1,74 @@
+// Check drawLine() against a plain per-pixel Bresenham over random lines,
+// with coordinates across the whole int16_t range, drawn into a RAM canvas.
+//
+//   g++ -std=gnu++17 -Iextras/host -Isrc extras/host/line_test.cpp -o line_test
+//   ./line_test
+#include <Arduino.h>
+#include <ILI9486_Display.h>
+
+static const int W = 480, H = 320;
+static uint8_t canvas[W * H * 2], expected[W * H * 2];
+
+static uint32_t seed = 1;
+static int32_t rnd(int32_t n) {
+  seed = seed * 1103515245 + 12345;
+  return (int32_t)((seed >> 8) % (uint32_t)n);
+}
+
+static void plot(int32_t x, int32_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= W || y >= H) return;
+  expected[(y * W + x) * 2] = color >> 8;
+  expected[(y * W + x) * 2 + 1] = color;
+}
+
+// Every pixel of the line, stepped along its major axis
+static void reference(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color) {
+  bool steep = labs(y1 - y0) > labs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+  int32_t dx = x1 - x0, dy = labs(y1 - y0), err = dx / 2, step = y0 < y1 ? 1 : -1;
+  for (; x0 <= x1; x0++) {
+    if (steep) plot(y0, x0, color);
+    else plot(x0, y0, color);
+    err -= dy;
+    if (err < 0) {
+      y0 += step;
+      err += dx;
+    }
+  }
+}
+
+static int16_t coord(int32_t range, int32_t centre) {
+  int32_t v = rnd(range) - range / 2 + centre;
+  return v < -32768 ? -32768 : v > 32767 ? 32767 : v;
+}
+
+int main() {
+  ILI9486_RamCanvas cv;
+  cv.setBuffer(canvas, W, H);
+  long bad = 0;
+
+  for (long t = 0; t < 200000; t++) {
+    // Full range, well off screen, near the screen
+    int32_t range = t % 4 == 0 ? 65536 : t % 4 == 1 ? 2000 : 700;
+    int16_t x0 = coord(range, W / 2), y0 = coord(range, H / 2);
+    int16_t x1 = coord(range, W / 2), y1 = coord(range, H / 2);
+    if (t % 6 == 4) y1 = y0;     // Axis-aligned lines take the fast path
+    if (t % 6 == 5) x1 = x0;
+    uint16_t color = t * 7 + 1;
+    cv.drawLine(x0, y0, x1, y1, color);
+    reference(x0, y0, x1, y1, color);
+    if ((t < 2000 || t % 1000 == 999) && memcmp(canvas, expected, sizeof(canvas))) {
+      if (++bad < 5) printf("mismatch by line %ld: %d,%d - %d,%d\n", t, x0, y0, x1, y1);
+      memcpy(canvas, expected, sizeof(canvas));
+    }
+  }
+  printf("drawLine: %ld mismatches\n", bad);
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+// Check the panel memory mirror against a model of the controller. Random
+// drawing in random rotations is decoded from the recorded byte stream into
+// the controller's memory (following MADCTL, the address window and the
+// memory write pointer), and after every step readPixel() must return what
+// that memory holds at each point of the current rotation - including what
+// was drawn before the rotation changed.
+//
+//   g++ -std=gnu++17 -Iextras/host -Isrc extras/host/mirror_test.cpp -o mirror_test
+//   ./mirror_test
+#include <Arduino.h>
+#include <ILI9486_Display.h>
+#include <ILI9486_HostBus.h>
+#include <vector>
+
+typedef ILI9486_Driver<ILI9486_HostBus> Display;
+
+static uint32_t seed = 1;
+static int rnd(int n) {
+  seed = seed * 1103515245 + 12345;
+  return (int)((seed >> 8) % (uint32_t)n);
+}
+
+// Controller memory: 320 columns by 480 pages
+struct Panel {
+  static const int COLS = 320, PAGES = 480;
+  std::vector<uint16_t> mem;
+  uint8_t madctl;
+  size_t next, nextCommand;   // Stream position already decoded
+  uint8_t cmd, param[4];
+  int params;
+  int x0, x1, y0, y1, x, y;
+  bool odd;
+  uint8_t hi;
+
+  Panel() : mem(COLS * PAGES, 0), madctl(0), next(0), nextCommand(0), cmd(0), params(0),
+            x0(0), x1(0), y0(0), y1(0), x(0), y(0), odd(false), hi(0) {}
+
+  // Memory cell of a column/page address pair: MV swaps them, MX and MY
+  // mirror the memory column and page
+  uint16_t &at(int c, int p) {
+    if (madctl & 0x20) std::swap(c, p);
+    if (madctl & 0x40) c = COLS - 1 - c;
+    if (madctl & 0x80) p = PAGES - 1 - p;
+    return mem[p * COLS + c];
+  }
+
+  void run(const ILI9486_HostBus &bus) {
+    const std::vector<uint8_t> &b = bus.bytes();
+    const std::vector<uint32_t> &cmds = bus.commandOffsets();
+    for (; next < b.size(); next++) {
+      if (nextCommand < cmds.size() && cmds[nextCommand] == next) {
+        nextCommand++;
+        cmd = b[next];
+        params = 0;
+        odd = false;
+        x = x0;
+        y = y0;
+        continue;
+      }
+      if (cmd == 0x2C) {
+        if (!odd) {
+          hi = b[next];
+          odd = true;
+          continue;
+        }
+        odd = false;
+        at(x, y) = (hi << 8) | b[next];
+        if (++x > x1) {
+          x = x0;
+          if (++y > y1) y = y0;
+        }
+      } else if (params < 4) {
+        param[params++] = b[next];
+        if (cmd == 0x36) madctl = param[0];
+        if (cmd == 0x2A && params == 4) {
+          x0 = (param[0] << 8) | param[1];
+          x1 = (param[2] << 8) | param[3];
+        }
+        if (cmd == 0x2B && params == 4) {
+          y0 = (param[0] << 8) | param[1];
+          y1 = (param[2] << 8) | param[3];
+        }
+      }
+    }
+  }
+};
+
+static uint16_t image[40 * 30];
+
+static void draw(Display &tft) {
+  int w = tft.width(), h = tft.height();
+  switch (rnd(6)) {
+    case 0:
+      tft.fillRect(rnd(w), rnd(h), rnd(200) + 1, rnd(150) + 1, rnd(65536));
+      break;
+    case 1:
+      tft.pushImage(rnd(w - 40), rnd(h - 30), 40, 30, image);
+      break;
+    case 2:
+      tft.setTextColor(rnd(65536), rnd(65536));
+      tft.drawString("Mirror", rnd(w - 40), rnd(h - 10), 1);
+      break;
+    case 3:
+      tft.drawLine(rnd(w), rnd(h), rnd(w), rnd(h), rnd(65536));
+      break;
+    case 4:
+      tft.fillCircle(rnd(w), rnd(h), rnd(40), rnd(65536));
+      break;
+    case 5:
+      if (rnd(4) == 0) tft.fillScreen(rnd(65536));
+      tft.drawPixel(rnd(w), rnd(h), rnd(65536));
+      break;
+  }
+}
+
+int main() {
+  for (int i = 0; i < 40 * 30; i++) image[i] = i * 91;
+  long bad = 0, checks = 0;
+  for (int compact = 0; compact < 2; compact++) {
+    for (int s = 1; s <= 20; s++) {
+      seed = s;
+      Display tft((ILI9486_HostBus()));
+      tft.begin();
+      int rotation = rnd(4);
+      tft.setRotation(rotation);
+      if (!tft.beginMirror(compact)) return 1;
+      tft.bus().clear();
+      tft.invalidateShadow();
+      tft.setRotation(rotation);   // Let the model see MADCTL
+      Panel panel;
+
+      for (int step = 0; step < 40; step++) {
+        if (rnd(3) == 0) {
+          rotation = rnd(4);
+          tft.setRotation(rotation);
+        }
+        for (int k = rnd(5) + 1; k > 0; k--) draw(tft);
+        panel.run(tft.bus());
+
+        long diff = 0;
+        for (int y = 0; y < tft.height(); y++) {
+          for (int x = 0; x < tft.width(); x++) {
+            if (tft.readPixel(x, y) != panel.at(x, y)) diff++;
+          }
+        }
+        checks++;
+        if (diff && ++bad < 5) {
+          printf("compact %d seed %d step %d rotation %d: %ld pixels differ\n", compact, s, step, rotation, diff);
+        }
+      }
+    }
+  }
+  printf("mirror: %ld bad of %ld checks\n", bad, checks);
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,219 @@
+// Check ILI9486_Region and ILI9486_WindowManager against reference bitmaps.
+// Regions are cut up by random rectangles until they run out of room; a
+// region must still cover every pixel of the exact area, and match it
+// exactly while it has room. Then random window layouts are opened, moved,
+// resized, raised, lowered and closed, and the panel (read back through the
+// mirror) must match every window drawn bottom to top from scratch.
+//
+//   g++ -std=gnu++17 -Iextras/host -Isrc extras/host/region_test.cpp -o region_test
+//   ./region_test
+#include <Arduino.h>
+#include <ILI9486_Display.h>
+#include <ILI9486_HostBus.h>
+#include <ILI9486_Window.h>
+#include <algorithm>
+#include <vector>
+
+typedef ILI9486_Driver<ILI9486_HostBus> Display;
+
+static const int W = 480, H = 320;
+static uint8_t exact[W * H], covered[W * H];
+static uint8_t expected[W * H * 2];
+static uint16_t image[40 * 30];
+
+static uint32_t seed = 1;
+static int rnd(int n) {
+  seed = seed * 1103515245 + 12345;
+  return (int)((seed >> 8) % (uint32_t)n);
+}
+
+static ILI9486_Rect randomRect(int maxW, int maxH) {
+  int x = rnd(W + 40) - 20, y = rnd(H + 40) - 20;
+  return { (int16_t)x, (int16_t)y, (int16_t)(x + rnd(maxW)), (int16_t)(y + rnd(maxH)) };
+}
+
+static void mark(uint8_t *bits, const ILI9486_Rect &r, uint8_t v) {
+  for (int y = r.y0 < 0 ? 0 : r.y0; y <= r.y1 && y < H; y++) {
+    for (int x = r.x0 < 0 ? 0 : r.x0; x <= r.x1 && x < W; x++) bits[y * W + x] = v;
+  }
+}
+
+// Pixels of the exact area the region misses, and pixels it covers beyond it
+static void compare(const ILI9486_Region &region, long &lost, long &extra) {
+  memset(covered, 0, sizeof(covered));
+  for (uint8_t i = 0; i < region.count(); i++) mark(covered, region[i], 1);
+  lost = extra = 0;
+  for (int i = 0; i < W * H; i++) {
+    if (exact[i] && !covered[i]) lost++;
+    if (!exact[i] && covered[i]) extra++;
+  }
+}
+
+static bool regions() {
+  long badLost = 0, badExact = 0, exactSteps = 0, full = 0;
+  for (int s = 1; s <= 200; s++) {
+    seed = s;
+    ILI9486_Region region, cut;
+    region.set({ 0, 0, W - 1, H - 1 });
+    memset(exact, 1, sizeof(exact));
+    bool overflowed = false;    // Whether a merge may have grown the region
+    for (int step = 0; step < 60; step++) {
+      // A cut turns each piece it overlaps into at most four, so below the
+      // limit the region has to stay exact
+      long most = region.count();
+      if (rnd(4) == 0) {
+        // A region cut out of another, as the window manager does
+        cut.clear();
+        for (int k = rnd(4) + 1; k > 0; k--) {
+          ILI9486_Rect r = randomRect(80, 60);
+          cut.subtract(r);
+          cut.add(r);
+        }
+        for (uint8_t i = 0; i < cut.count(); i++) {
+          mark(exact, cut[i], 0);
+          most *= 4;
+        }
+        region.subtract(cut);
+      } else {
+        ILI9486_Rect r = randomRect(s & 1 ? 40 : 160, s & 1 ? 30 : 120);
+        for (uint8_t i = 0; i < region.count(); i++) {
+          const ILI9486_Rect &a = region[i];
+          if (a.x1 >= r.x0 && a.x0 <= r.x1 && a.y1 >= r.y0 && a.y0 <= r.y1) most += 3;
+        }
+        mark(exact, r, 0);
+        region.subtract(r);
+      }
+      if (most > ILI9486_REGION_RECTS) overflowed = true;
+      long lost, extra;
+      compare(region, lost, extra);
+      if (lost && ++badLost < 5) printf("seed %d step %d: %ld pixels lost\n", s, step, lost);
+      if (!overflowed) exactSteps++;
+      if (!overflowed && extra && ++badExact < 5) printf("seed %d step %d: %ld extra pixels\n", s, step, extra);
+    }
+    if (overflowed) full++;
+  }
+  printf("regions: %ld lost, %ld inexact of %ld exact steps, %ld of 200 ran out of room\n",
+         badLost, badExact, exactSteps, full);
+  return !badLost && !badExact;
+}
+
+// Window content: a fill, a frame, a disc and an image, in window coordinates
+template <class Target>
+static void content(Target &t, int x, int y, int w, int h, uint16_t color) {
+  t.fillRect(x, y, w, h, color);
+  t.drawRect(x, y, w, h, TFT_WHITE);
+  t.fillCircle(x + w / 2, y + h / 2, std::min(w, h) / 3, color ^ 0xFFFF);
+  if (w > 45 && h > 35) {
+    t.pushRows(x + 2, y + 2, 40, 30, [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+      memcpy(dst, &image[row * 40 + col], count * 2);
+    });
+  }
+}
+
+static void paint(ILI9486_Window<Display> &win, void *user) {
+  content(win, 0, 0, win.width(), win.height(), (uint16_t)(intptr_t)user);
+}
+
+struct Model {
+  int x, y, w, h;
+  uint16_t color;
+};
+
+static bool windows() {
+  for (int i = 0; i < 40 * 30; i++) image[i] = i * 91;
+  long bad = 0, steps = 0, sent = 0, full = 0;
+  for (int rot = 0; rot < 2; rot++) {
+    for (int s = 1; s <= 30; s++) {
+      seed = s;
+      Display tft((ILI9486_HostBus()));
+      tft.begin();
+      tft.setRotation(rot);
+      tft.bus().setCapture(false);
+      tft.beginMirror();
+      ILI9486_WindowManager<Display> wm(tft, TFT_DARKGREY);
+      wm.redraw();
+      int w = tft.width(), h = tft.height();
+      Model m[ILI9486_MAX_WINDOWS];
+      std::vector<int> order;
+
+      for (int step = 0; step < 80; step++) {
+        tft.bus().clear();
+        int id = order.empty() ? -1 : order[rnd(order.size())];
+        int op = order.size() < 3 ? 0 : rnd(8);
+        if (op == 0 && order.size() == ILI9486_MAX_WINDOWS) op = 1;
+        switch (op) {
+          case 0: {
+            // Many small windows fragment the desktop most
+            Model n = { rnd(w), rnd(h), rnd(s & 1 ? 80 : 250) + 10, rnd(s & 1 ? 60 : 180) + 10, (uint16_t)rnd(65536) };
+            int fresh = wm.open(n.x, n.y, n.w, n.h, paint, (void *)(intptr_t)n.color);
+            if (fresh >= 0) {
+              m[fresh] = n;
+              order.push_back(fresh);
+            }
+            break;
+          }
+          case 1:
+            wm.close(id);
+            order.erase(std::find(order.begin(), order.end(), id));
+            break;
+          case 2:
+          case 3: {
+            int x = std::max(0, m[id].x + rnd(81) - 40), y = std::max(0, m[id].y + rnd(61) - 30);
+            wm.move(id, x, y);
+            m[id].x = x;
+            m[id].y = y;
+            break;
+          }
+          case 4:
+            wm.raise(id);
+            order.erase(std::find(order.begin(), order.end(), id));
+            order.push_back(id);
+            break;
+          case 5:
+            wm.lower(id);
+            order.erase(std::find(order.begin(), order.end(), id));
+            order.insert(order.begin(), id);
+            break;
+          case 6: {
+            int nw = rnd(250) + 10, nh = rnd(180) + 10;
+            wm.resize(id, nw, nh);
+            m[id].w = nw;
+            m[id].h = nh;
+            break;
+          }
+          case 7:
+            paint(wm.window(id), (void *)(intptr_t)m[id].color);   // The app draws on its own
+            break;
+        }
+        steps++;
+        sent += tft.bus().stats().totalBytes();
+        full += (long)w * h * 2;
+
+        ILI9486_RamCanvas cv;
+        cv.setBuffer(expected, w, h);
+        cv.fillScreen(TFT_DARKGREY);
+        for (int i : order) {
+          cv.setClip(m[i].x, m[i].y, m[i].w, m[i].h);
+          content(cv, m[i].x, m[i].y, m[i].w, m[i].h, m[i].color);
+          cv.clearClip();
+        }
+        long diff = 0;
+        for (int y = 0; y < h; y++) {
+          for (int x = 0; x < w; x++) {
+            const uint8_t *px = &expected[(y * w + x) * 2];
+            if (tft.readPixel(x, y) != ((px[0] << 8) | px[1])) diff++;
+          }
+        }
+        if (diff && ++bad < 5) printf("rotation %d seed %d step %d op %d: %ld pixels differ\n", rot, s, step, op, diff);
+      }
+    }
+  }
+  printf("windows: %ld bad steps of %ld, %.1f%% of full redraw bytes\n", bad, steps, 100.0 * sent / full);
+  return !bad;
+}
+
+int main() {
+  bool ok = regions();
+  ok = windows() && ok;
+  return ok ? 0 : 1;
+}
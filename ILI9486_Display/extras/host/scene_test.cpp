@@ -0,0 +1,260 @@
+// Check ILI9486_Scene against a full redraw. Random scenes are edited step by
+// step; after each update() the panel (read back through the mirror) must
+// match the whole scene drawn from scratch into a RAM canvas, so damage that
+// misses a changed area shows up as wrong pixels. Occlusion is checked by
+// counting the nodes an update draws under an opaque node.
+//
+//   g++ -std=gnu++17 -Iextras/host -Isrc extras/host/scene_test.cpp -o scene_test
+//   ./scene_test
+#include <Arduino.h>
+#include <ILI9486_Display.h>
+#include <ILI9486_HostBus.h>
+#include <ILI9486_Scene.h>
+#include <algorithm>
+#include <vector>
+#include "../../examples/FontExample/FreeSans9pt7b.h"
+
+typedef ILI9486_Driver<ILI9486_HostBus> Display;
+
+static const int NODES = 120;
+static uint16_t image[40 * 30];
+static uint8_t expected[480 * 320 * 2];
+
+static uint32_t seed = 1;
+static int32_t rnd(int32_t n) {
+  seed = seed * 1103515245 + 12345;
+  return (int32_t)((seed >> 8) % (uint32_t)n);
+}
+
+// What the scene should hold, kept alongside it
+enum { RECT, FRAME, CIRCLE, DISC, LINE, IMAGE, LABEL, TEXT, KINDS };
+struct Model {
+  bool live, visible;
+  int kind, z;
+  long order;             // Raised later = drawn later within the same z
+  int x, y, w, h;         // Lines: second end in w, h
+  uint16_t color, bg;
+  const char *text;
+  const GFXfont *font;
+  uint8_t size, datum;
+};
+
+static const char *texts[] = { "Hello", "21.5 C", "Scene graph", "x" };
+
+// fillRect() takes unsigned coordinates, so boxes that start off screen are
+// filled through a clip
+static void fillBox(ILI9486_RamCanvas &cv, int x, int y, int w, int h, uint16_t color) {
+  cv.setClip(x, y, w, h);
+  cv.fillScreen(color);
+  cv.clearClip();
+}
+
+static void drawModel(ILI9486_RamCanvas &cv, const Model &n) {
+  switch (n.kind) {
+    case RECT:
+      fillBox(cv, n.x, n.y, n.w, n.h, n.color);
+      break;
+    case FRAME:
+      fillBox(cv, n.x, n.y, n.w, 1, n.color);
+      fillBox(cv, n.x, n.y + n.h - 1, n.w, 1, n.color);
+      fillBox(cv, n.x, n.y, 1, n.h, n.color);
+      fillBox(cv, n.x + n.w - 1, n.y, 1, n.h, n.color);
+      break;
+    case CIRCLE:
+      cv.drawCircle(n.x, n.y, n.w, n.color);
+      break;
+    case DISC:
+      cv.fillCircle(n.x, n.y, n.w, n.color);
+      break;
+    case LINE:
+      cv.drawLine(n.x, n.y, n.w, n.h, n.color);
+      break;
+    case IMAGE:
+      cv.setClip(n.x, n.y, n.w, n.h);
+      cv.pushRows(n.x, n.y, n.w, n.h, [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+        memcpy(dst, &image[row * 40 + col], count * 2);
+      });
+      break;
+    default: {
+      if (n.kind == LABEL) fillBox(cv, n.x, n.y, n.w, n.h, n.bg);
+      cv.setClip(n.x, n.y, n.w, n.h);
+      int col = n.datum % 3, row = n.datum / 3;
+      cv.setFreeFont(n.font);
+      cv.setTextSize(n.size);
+      cv.setTextDatum(n.datum);
+      cv.setTextColor(n.color);
+      cv.drawString(n.text, col == 0 ? n.x : col == 1 ? n.x + n.w / 2 : n.x + n.w - 1,
+                    row == 0 ? n.y : row == 1 ? n.y + n.h / 2 : n.y + n.h - 1);
+      break;
+    }
+  }
+  cv.clearClip();
+}
+
+// Pixels of the panel that differ from the whole model drawn from scratch
+static long compare(Display &tft, const std::vector<Model> &m, uint16_t bg) {
+  ILI9486_RamCanvas cv;
+  cv.setBuffer(expected, tft.width(), tft.height());
+  cv.fillScreen(bg);
+  std::vector<int> order;
+  for (int i = 0; i < NODES; i++) {
+    if (m[i].live && m[i].visible) order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return m[a].z != m[b].z ? m[a].z < m[b].z : m[a].order < m[b].order;
+  });
+  for (int i : order) drawModel(cv, m[i]);
+
+  long bad = 0;
+  for (int y = 0; y < tft.height(); y++) {
+    for (int x = 0; x < tft.width(); x++) {
+      const uint8_t *px = &expected[(y * tft.width() + x) * 2];
+      if (tft.readPixel(x, y) != ((px[0] << 8) | px[1])) bad++;
+    }
+  }
+  return bad;
+}
+
+int main() {
+  for (int i = 0; i < 40 * 30; i++) image[i] = i * 91;
+  long bad = 0, sent = 0, full = 0;
+  const uint16_t bg = TFT_BLUE;
+
+  // Random edits, in both orientations, drawing directly and under
+  // beginDeferred() (the scene must keep its strips out of the list)
+  for (int pass = 0; pass < 4; pass++) {
+    for (int s = 1; s <= 8; s++) {
+      seed = s;
+      Display tft((ILI9486_HostBus()));
+      tft.begin();
+      tft.setRotation(pass & 1);
+      tft.bus().setCapture(false);
+      tft.beginMirror();
+      ILI9486_Scene<Display> scene(tft);
+      if (!scene.begin(NODES, bg)) return 1;
+      std::vector<Model> m(NODES);
+      long order = 0;
+
+      auto add = [&]() {
+        Model n = { true, true, (int)rnd(KINDS), (int)rnd(5), order++,
+                    (int)rnd(520) - 20, (int)rnd(360) - 20, (int)rnd(150) + 1, (int)rnd(100) + 1,
+                    (uint16_t)rnd(65536), (uint16_t)rnd(65536), texts[rnd(4)], nullptr, 1, TL_DATUM };
+        int id = -1;
+        switch (n.kind) {
+          case RECT: id = scene.addRect(n.x, n.y, n.w, n.h, n.color, n.z); break;
+          case FRAME: id = scene.addFrame(n.x, n.y, n.w, n.h, n.color, n.z); break;
+          case CIRCLE: n.w = n.h = n.w / 3; id = scene.addCircle(n.x, n.y, n.w, n.color, n.z); break;
+          case DISC: n.w = n.h = n.w / 3; id = scene.addDisc(n.x, n.y, n.w, n.color, n.z); break;
+          case LINE:
+            // Some lines run far outside the int16_t range of a node's size
+            if (rnd(4) == 0) {
+              n.x = rnd(2) ? -30000 : 30000;
+              n.w = -n.x + rnd(400);
+            } else {
+              n.w += n.x - 75;
+            }
+            n.h += n.y - 50;
+            id = scene.addLine(n.x, n.y, n.w, n.h, n.color, n.z);
+            break;
+          case IMAGE: n.w = 40; n.h = 30; id = scene.addImage(n.x, n.y, n.w, n.h, image, n.z); break;
+          case LABEL: id = scene.addLabel(n.x, n.y, n.w, n.h, n.text, n.color, n.bg, n.z); break;
+          case TEXT: id = scene.addText(n.x, n.y, n.w, n.h, n.text, n.color, n.z); break;
+        }
+        if (id < 0) return;
+        if (n.kind >= LABEL && rnd(2)) {
+          n.font = &FreeSans9pt7b;
+          n.size = 1 + rnd(2);
+          n.datum = rnd(9);
+          scene.setFont(id, n.font, n.size, n.datum);
+        }
+        m[id] = n;
+      };
+
+      for (int i = 0; i < 50; i++) add();
+      for (int step = 0; step < 30; step++) {
+        for (int c = step ? rnd(4) + 1 : 0; c > 0; c--) {
+          int id = rnd(NODES);
+          Model &n = m[id];
+          if (!n.live) {
+            add();
+            continue;
+          }
+          switch (rnd(7)) {
+            case 0: {
+              int x = n.x + rnd(41) - 20, y = n.y + rnd(41) - 20;
+              if (scene.moveTo(id, x, y)) {
+                if (n.kind == LINE) {
+                  n.w += x - n.x;
+                  n.h += y - n.y;
+                }
+                n.x = x;
+                n.y = y;
+              }
+              break;
+            }
+            case 1: {
+              uint16_t color = rnd(65536);
+              if (scene.setColor(id, color)) n.color = color;
+              break;
+            }
+            case 2:
+              n.z = rnd(5);
+              scene.setZ(id, n.z);
+              n.order = order++;
+              break;
+            case 3:
+              n.visible = rnd(2);
+              scene.setVisible(id, n.visible);
+              break;
+            case 4:
+              scene.remove(id);
+              n.live = false;
+              break;
+            case 5: {
+              const char *text = texts[rnd(4)];
+              if (scene.setText(id, text)) n.text = text;
+              break;
+            }
+            case 6: {
+              int w = rnd(150) + 1, h = rnd(100) + 1;
+              if (n.kind == CIRCLE || n.kind == DISC) h = w;
+              if (scene.setSize(id, w, h)) {
+                n.w = w;
+                n.h = h;
+              }
+              break;
+            }
+          }
+        }
+
+        tft.bus().clear();
+        if (pass >= 2) tft.beginDeferred(64);
+        scene.update();
+        if (pass >= 2) tft.endDeferred();
+        sent += tft.bus().stats().totalBytes();
+        full += (long)tft.width() * tft.height() * 2;
+        long diff = compare(tft, m, bg);
+        if (diff && ++bad < 5) printf("pass %d seed %d step %d: %ld pixels differ\n", pass, s, step, diff);
+      }
+    }
+  }
+  printf("scene: %ld bad updates, %.1f%% of full redraw bytes\n", bad, 100.0 * sent / full);
+
+  // Occlusion: under a full-screen opaque rectangle, changing a node must
+  // only redraw the rectangle over the damaged area (small enough to be
+  // sent as one band)
+  Display tft((ILI9486_HostBus()));
+  tft.begin();
+  ILI9486_Scene<Display> scene(tft);
+  scene.begin(8, bg);
+  int16_t disc = scene.addDisc(100, 100, 10, TFT_RED);
+  scene.addText(90, 90, 40, 20, "hidden", TFT_WHITE);
+  scene.addRect(0, 0, tft.width(), tft.height(), TFT_GREEN, 1);
+  scene.update();
+  scene.moveTo(disc, 105, 105);
+  scene.update();
+  bool occluded = scene.nodesDrawn() == 1;
+  printf("occlusion: %u node draws under a covering rectangle  %s\n", scene.nodesDrawn(), occluded ? "ok" : "FAIL");
+
+  return bad || !occluded ? 1 : 0;
+}
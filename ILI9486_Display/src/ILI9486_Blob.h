@@ -0,0 +1,220 @@
+#ifndef ILI9486_BLOB_H
+#define ILI9486_BLOB_H
+
+#include <Arduino.h>
+#include "ILI9486_Bus.h"
+
+// Precompiled screen blobs.
+//
+// A blob is the command/data stream a sequence of draw calls sent to the
+// panel, stored so it can be replayed with ILI9486_Driver::pushBlob() without
+// rasterizing anything. Runs of identical pixels are stored once.
+//
+// Format (multi-byte values little-endian):
+//   'I' 'L' 'B' version                Header
+//   0x01 cmd                           Command byte
+//   0x02 len16 bytes...                Data bytes
+//   0x03 count32 hi lo                 Data word hi:lo repeated count times
+//   0x00                               End
+#define ILI9486_BLOB_VERSION 1
+#define ILI9486_BLOB_END     0x00
+#define ILI9486_BLOB_CMD     0x01
+#define ILI9486_BLOB_DATA    0x02
+#define ILI9486_BLOB_FILL    0x03
+
+// Recording transport. Draw into an ILI9486_Driver<ILI9486_BlobBus> and the
+// stream is encoded into the caller's buffer instead of being sent anywhere.
+// Works on the device (e.g. to cache a screen in RAM) and on a desktop host
+// (see extras/host/blob_tool.cpp, which turns a screen into a C array):
+//
+//   static uint8_t buf[65536];
+//   ILI9486_Driver<ILI9486_BlobBus> rec((ILI9486_BlobBus(buf, sizeof(buf))));
+//   rec.begin();
+//   rec.bus().clear();          // Drop the init sequence
+//   rec.invalidateShadow();     // Make the blob carry its own window/MADCTL setup
+//   rec.setRotation(1);
+//   drawSettingsScreen(rec);
+//   size_t len = rec.bus().finish();   // 0 if buf was too small
+class ILI9486_BlobBus {
+public:
+  static const uint8_t MIN_RUN = 4;  // Shortest pixel run stored as a fill record
+
+  ILI9486_BlobBus(uint8_t *buf, size_t capacity) : _buf(buf), _cap(capacity), _fence(0) { clear(); }
+
+  void begin(uint32_t) {}
+  void hardwareReset() {}
+  void beginTransaction() {}
+  void endTransaction() {}
+
+  void writeCommand(uint8_t cmd) {
+    flush();
+    emit(ILI9486_BLOB_CMD);
+    emit(cmd);
+  }
+
+  void write(uint8_t data) { feedByte(data); }
+
+  void write16(uint16_t data) {
+    feedByte(data >> 8);
+    feedByte(data & 0xFF);
+  }
+
+  void writeBytes(const uint8_t *data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+      feedByte(data[i]);
+    }
+  }
+
+  void writePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total) {
+    // Solid fills arrive as a repeated one-color pattern: extend the run in one step
+    if (!_odd && (bufLen & 1) == 0 && (total & 1) == 0 && uniform(buf, bufLen)) {
+      feedRun((buf[0] << 8) | buf[1], total / 2);
+      return;
+    }
+    while (total > 0) {
+      uint32_t chunk = total < bufLen ? total : bufLen;
+      writeBytes(buf, chunk);
+      total -= chunk;
+    }
+  }
+
+  // Nothing is in flight, so queued writes complete immediately
+  ILI9486_Fence queueBytes(const uint8_t *data, uint32_t len) {
+    writeBytes(data, len);
+    return ++_fence;
+  }
+
+  ILI9486_Fence queuePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total) {
+    writePattern(buf, bufLen, total);
+    return ++_fence;
+  }
+
+  bool fenceDone(ILI9486_Fence) { return true; }
+  void waitFence(ILI9486_Fence) {}
+  bool busy() { return false; }
+  void waitIdle() {}
+
+  // Start a new blob (the header is written immediately)
+  void clear() {
+    _len = 0;
+    _overflow = false;
+    _dataOpen = false;
+    _odd = false;
+    _runLen = 0;
+    emit('I');
+    emit('L');
+    emit('B');
+    emit(ILI9486_BLOB_VERSION);
+  }
+
+  // Terminate the blob. Returns its length, or 0 if the buffer overflowed.
+  size_t finish() {
+    flush();
+    emit(ILI9486_BLOB_END);
+    return _overflow ? 0 : _len;
+  }
+
+  const uint8_t *data() const { return _buf; }
+  size_t size() const { return _len; }
+  bool overflow() const { return _overflow; }
+
+private:
+  uint8_t *_buf;
+  size_t _cap, _len;
+  bool _overflow;
+  ILI9486_Fence _fence;
+  bool _dataOpen;           // A data record is open for appending
+  size_t _dataPos;          // Offset of its length field
+  uint16_t _dataLen;
+  bool _odd;                // Holding the first byte of a data word
+  uint8_t _oddByte;
+  uint16_t _runWord;        // Current run of identical data words
+  uint32_t _runLen;
+
+  void emit(uint8_t b) {
+    if (_len < _cap) {
+      _buf[_len++] = b;
+    } else {
+      _overflow = true;
+    }
+  }
+
+  static bool uniform(const uint8_t *buf, uint32_t len) {
+    if (len < 2) return false;
+    for (uint32_t i = 2; i < len; i += 2) {
+      if (buf[i] != buf[0] || buf[i + 1] != buf[1]) return false;
+    }
+    return true;
+  }
+
+  // Data is tracked as 16-bit words counted from the last command, so runs
+  // stay aligned to pixels
+  void feedByte(uint8_t b) {
+    if (!_odd) {
+      _oddByte = b;
+      _odd = true;
+    } else {
+      _odd = false;
+      feedRun((_oddByte << 8) | b, 1);
+    }
+  }
+
+  void feedRun(uint16_t word, uint32_t count) {
+    if (_runLen > 0 && word != _runWord) flushRun();
+    _runWord = word;
+    _runLen += count;
+  }
+
+  void flushRun() {
+    if (_runLen >= MIN_RUN) {
+      closeData();
+      emit(ILI9486_BLOB_FILL);
+      for (uint8_t i = 0; i < 4; i++) {
+        emit(_runLen >> (8 * i));
+      }
+      emit(_runWord >> 8);
+      emit(_runWord & 0xFF);
+    } else {
+      for (uint32_t i = 0; i < _runLen; i++) {
+        literal(_runWord >> 8);
+        literal(_runWord & 0xFF);
+      }
+    }
+    _runLen = 0;
+  }
+
+  void literal(uint8_t b) {
+    if (!_dataOpen || _dataLen == 0xFFFF) {
+      closeData();
+      emit(ILI9486_BLOB_DATA);
+      _dataPos = _len;
+      emit(0);
+      emit(0);
+      _dataOpen = true;
+      _dataLen = 0;
+    }
+    emit(b);
+    _dataLen++;
+  }
+
+  void closeData() {
+    if (!_dataOpen) return;
+    if (_dataPos + 1 < _cap) {
+      _buf[_dataPos] = _dataLen & 0xFF;
+      _buf[_dataPos + 1] = _dataLen >> 8;
+    }
+    _dataOpen = false;
+  }
+
+  // End of a command's data: everything pending becomes a record
+  void flush() {
+    flushRun();
+    if (_odd) {
+      literal(_oddByte);
+      _odd = false;
+    }
+    closeData();
+  }
+};
+
+#endif // ILI9486_BLOB_H
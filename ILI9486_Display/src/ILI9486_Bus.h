@@ -0,0 +1,429 @@
+#ifndef ILI9486_BUS_H
+#define ILI9486_BUS_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "ILI9486_Pins.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "driver/spi_master.h"
+#include "esp_heap_caps.h"
+#else
+#include <stdlib.h>
+#endif
+
+// Handle returned by queued (asynchronous) transfers. Fences complete in
+// the order they were issued; 0 is never issued and is always complete.
+typedef uint32_t ILI9486_Fence;
+
+// Buffers handed to queued transfers must be reachable by the SPI DMA engine.
+// On the ESP32 that means internal DMA-capable RAM (not PSRAM, not flash).
+static inline void *ili9486_dma_alloc(size_t bytes) {
+#if defined(ARDUINO_ARCH_ESP32)
+  return heap_caps_malloc(bytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+#else
+  return malloc(bytes);
+#endif
+}
+
+static inline void ili9486_dma_free(void *buf) {
+#if defined(ARDUINO_ARCH_ESP32)
+  heap_caps_free(buf);
+#else
+  free(buf);
+#endif
+}
+
+// Large CPU-only buffers (frame canvases) prefer PSRAM when the board has it
+static inline void *ili9486_frame_alloc(size_t bytes) {
+#if defined(ARDUINO_ARCH_ESP32)
+  void *buf = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  return buf ? buf : heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+#else
+  return malloc(bytes);
+#endif
+}
+
+// Bus transports for ILI9486_Driver.
+//
+// A transport owns the wires to the panel. The driver only ever talks to it
+// through this small interface, so the drawing code can run against real SPI
+// hardware or against the in-memory recorder in ILI9486_HostBus.h:
+//
+//   void begin(uint32_t freq);             // Set up pins and bus
+//   void hardwareReset();                  // Pulse RST (if connected)
+//   void beginTransaction();               // Claim the bus, CS low
+//   void endTransaction();                 // CS high and release the bus once
+//                                          // queued data has been sent
+//   void writeCommand(uint8_t cmd);        // DC low, one byte, DC back high
+//   void write(uint8_t data);              // One data byte
+//   void write16(uint16_t data);           // One data word, MSB first
+//   void writeBytes(const uint8_t *data, uint32_t len);
+//   void writePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total);
+//                                          // Repeat buf until total bytes are sent
+//
+// Asynchronous data writes return a fence. The buffer must stay untouched
+// until that fence has completed. Synchronous writes and commands wait for
+// all queued data first, so the byte order on the wire is always the call order.
+//
+//   ILI9486_Fence queueBytes(const uint8_t *data, uint32_t len);
+//   ILI9486_Fence queuePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total);
+//   bool fenceDone(ILI9486_Fence fence);   // Non-blocking completion check
+//   void waitFence(ILI9486_Fence fence);   // Block until fence completes
+//   bool busy();                           // Any queued data still on the wire?
+//   void waitIdle();                       // Block until everything is sent
+//
+// Data writes are only issued between beginTransaction() and endTransaction().
+// Blocking transports simply complete queued writes before returning.
+// Queueing transports return from endTransaction() at once and end the
+// transaction when the last queued write completes; a beginTransaction()
+// before that keeps the bus and CS as they are.
+
+// Hardware SPI transport using the Arduino SPI object
+template <class Pins>
+class ILI9486_SPIBus {
+public:
+  ILI9486_SPIBus(const Pins &pins, int8_t mosi, int8_t sclk, SPIClass &spi = SPI)
+    : _pins(pins), _spi(&spi), _mosi(mosi), _sclk(sclk), _freq(27000000) {}
+
+  void begin(uint32_t freq) {
+    _pins.begin();
+    // Clock, mode and bit order are applied per transaction
+    _spi->begin(_sclk, -1, _mosi, -1);
+    _freq = freq;
+  }
+
+  void hardwareReset() {
+    _pins.rstLow();
+    delay(20);
+    _pins.rstHigh();
+    delay(150);
+  }
+
+  void beginTransaction() {
+    _spi->beginTransaction(SPISettings(_freq, MSBFIRST, SPI_MODE0));
+    _pins.csLow();
+  }
+
+  void endTransaction() {
+    _pins.csHigh();
+    _spi->endTransaction();
+  }
+
+  inline void writeCommand(uint8_t cmd) {
+    _pins.dcCommand();
+    _spi->transfer(cmd);
+    _pins.dcData();
+  }
+
+  inline void write(uint8_t data) { _spi->transfer(data); }
+
+  inline void write16(uint16_t data) {
+    _spi->transfer(data >> 8);
+    _spi->transfer(data & 0xFF);
+  }
+
+  inline void writeBytes(const uint8_t *data, uint32_t len) { _spi->writeBytes(data, len); }
+
+  void writePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total) {
+    while (total >= bufLen) {
+      _spi->writeBytes(buf, bufLen);
+      total -= bufLen;
+    }
+    if (total > 0) {
+      _spi->writeBytes(buf, total);
+    }
+  }
+
+  // The Arduino SPI driver blocks, so queued writes complete immediately
+  ILI9486_Fence queueBytes(const uint8_t *data, uint32_t len) {
+    writeBytes(data, len);
+    return ++_fence;
+  }
+
+  ILI9486_Fence queuePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total) {
+    writePattern(buf, bufLen, total);
+    return ++_fence;
+  }
+
+  bool fenceDone(ILI9486_Fence) { return true; }
+  void waitFence(ILI9486_Fence) {}
+  bool busy() { return false; }
+  void waitIdle() {}
+
+private:
+  Pins _pins;
+  SPIClass *_spi;
+  int8_t _mosi, _sclk;
+  uint32_t _freq;
+  ILI9486_Fence _fence = 0;
+};
+
+// Largest single DMA transaction (bytes)
+#ifndef ILI9486_DMA_MAX_TRANSFER
+#define ILI9486_DMA_MAX_TRANSFER 32768
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+// Priority of the task that keeps queued DMA transfers going
+#ifndef ILI9486_DMA_TASK_PRIORITY
+#define ILI9486_DMA_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#endif
+
+// ESP-IDF spi_master transport with queued DMA transfers.
+//
+// Queued writes are split into transactions and handed to the SPI driver;
+// the call returns as soon as they are queued. Only QUEUE_DEPTH transactions
+// fit in the driver's queue, so a completion task collects each finished
+// transaction and tops the queue up from the writes still waiting. Long
+// transfers keep going while the caller does other work, without polling,
+// and the task also raises CS and releases the bus after the last one.
+// This transport owns the SPI host, so do not also use the Arduino SPI
+// object on it.
+template <class Pins>
+class ILI9486_DMABus {
+public:
+  static const uint8_t QUEUE_DEPTH = 6;  // Transactions in flight
+  static const uint8_t JOB_DEPTH = 8;    // Queued writes waiting for a slot
+
+  ILI9486_DMABus(const Pins &pins, int8_t mosi, int8_t sclk, spi_host_device_t host = SPI2_HOST)
+    : _pins(pins), _mosi(mosi), _sclk(sclk), _host(host), _dev(nullptr), _task(nullptr), _done(nullptr),
+      _inFlight(0), _next(0), _jobHead(0), _jobCount(0), _releasePending(false), _fenceIssued(0), _fenceDone(0) {}
+
+  ~ILI9486_DMABus() {
+    if (_task) {
+      waitIdle();
+      vTaskDelete(_task);
+      vSemaphoreDelete(_done);
+    }
+  }
+
+  void begin(uint32_t freq) {
+    _pins.begin();
+
+    spi_bus_config_t buscfg = {};
+    buscfg.mosi_io_num = _mosi;
+    buscfg.miso_io_num = -1;
+    buscfg.sclk_io_num = _sclk;
+    buscfg.quadwp_io_num = -1;
+    buscfg.quadhd_io_num = -1;
+    buscfg.max_transfer_sz = ILI9486_DMA_MAX_TRANSFER;
+    spi_bus_initialize(_host, &buscfg, SPI_DMA_CH_AUTO);
+
+    spi_device_interface_config_t devcfg = {};
+    devcfg.clock_speed_hz = freq;
+    devcfg.mode = 0;
+    devcfg.spics_io_num = -1;           // CS is driven by the pin policy
+    devcfg.queue_size = QUEUE_DEPTH;
+    spi_bus_add_device(_host, &devcfg, &_dev);
+
+    if (!_task) {
+      portMUX_INITIALIZE(&_lock);
+      _done = xSemaphoreCreateBinary();
+      xTaskCreate(completionTask, "ili9486_dma", 2048, this, ILI9486_DMA_TASK_PRIORITY, &_task);
+    }
+  }
+
+  void hardwareReset() {
+    _pins.rstLow();
+    delay(20);
+    _pins.rstHigh();
+    delay(150);
+  }
+
+  // Reuses the bus if the last transaction is still waiting for its data
+  void beginTransaction() {
+    taskENTER_CRITICAL(&_lock);
+    bool held = _releasePending;
+    _releasePending = false;
+    taskEXIT_CRITICAL(&_lock);
+    if (held) return;
+    spi_device_acquire_bus(_dev, portMAX_DELAY);
+    _pins.csLow();
+  }
+
+  // Leaves the release to the completion task while data is still queued
+  void endTransaction() {
+    taskENTER_CRITICAL(&_lock);
+    bool idle = _inFlight == 0 && _jobCount == 0;
+    if (!idle) _releasePending = true;
+    taskEXIT_CRITICAL(&_lock);
+    if (idle) release();
+  }
+
+  void writeCommand(uint8_t cmd) {
+    waitIdle();
+    _pins.dcCommand();
+    transmit(&cmd, 1);
+    _pins.dcData();
+  }
+
+  void write(uint8_t data) {
+    waitIdle();
+    transmit(&data, 1);
+  }
+
+  void write16(uint16_t data) {
+    uint8_t buf[2] = { (uint8_t)(data >> 8), (uint8_t)(data & 0xFF) };
+    waitIdle();
+    transmit(buf, 2);
+  }
+
+  void writeBytes(const uint8_t *data, uint32_t len) {
+    waitIdle();
+    while (len > 0) {
+      uint32_t chunk = len < ILI9486_DMA_MAX_TRANSFER ? len : ILI9486_DMA_MAX_TRANSFER;
+      transmit(data, chunk);
+      data += chunk;
+      len -= chunk;
+    }
+  }
+
+  void writePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total) {
+    waitFence(queuePattern(buf, bufLen, total));
+  }
+
+  ILI9486_Fence queueBytes(const uint8_t *data, uint32_t len) {
+    return addJob(data, len, len, false);
+  }
+
+  ILI9486_Fence queuePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total) {
+    return addJob(buf, bufLen, total, true);
+  }
+
+  bool fenceDone(ILI9486_Fence fence) { return fence <= _fenceDone; }
+
+  // The completion task signals _done whenever a transaction finishes
+  void waitFence(ILI9486_Fence fence) {
+    while (fence > _fenceDone) {
+      xSemaphoreTake(_done, portMAX_DELAY);
+    }
+  }
+
+  bool busy() { return !fenceDone(_fenceIssued); }
+  void waitIdle() { waitFence(_fenceIssued); }
+
+private:
+  struct Job {
+    const uint8_t *buf;
+    uint32_t bufLen;        // Pattern length (pattern jobs)
+    uint32_t remaining;     // Bytes still to queue
+    ILI9486_Fence fence;
+    bool pattern;           // Re-send buf from the start for each transaction
+  };
+
+  Pins _pins;
+  int8_t _mosi, _sclk;
+  spi_host_device_t _host;
+  spi_device_handle_t _dev;
+  TaskHandle_t _task;
+  SemaphoreHandle_t _done;
+  portMUX_TYPE _lock;       // Guards the job ring between the caller and the task
+  spi_transaction_t _trans[QUEUE_DEPTH];
+  volatile uint8_t _inFlight;  // Changed by the completion task only
+  uint8_t _next;
+  Job _jobs[JOB_DEPTH];
+  volatile uint8_t _jobHead, _jobCount;
+  volatile bool _releasePending;  // endTransaction() came while data was queued
+  ILI9486_Fence _fenceIssued;
+  volatile ILI9486_Fence _fenceDone;
+
+  void release() {
+    _pins.csHigh();
+    spi_device_release_bus(_dev);
+  }
+
+  // Blocking transfer, only valid while nothing is queued
+  void transmit(const uint8_t *data, uint32_t len) {
+    spi_transaction_t t = {};
+    t.length = len * 8;
+    if (len <= 4) {
+      t.flags = SPI_TRANS_USE_TXDATA;
+      memcpy(t.tx_data, data, len);
+    } else {
+      t.tx_buffer = data;
+    }
+    spi_device_polling_transmit(_dev, &t);
+  }
+
+  // Hand a write to the completion task, waiting for a free job slot
+  ILI9486_Fence addJob(const uint8_t *buf, uint32_t bufLen, uint32_t total, bool pattern) {
+    if (total == 0) return _fenceDone;
+    while (_jobCount == JOB_DEPTH) {
+      xSemaphoreTake(_done, portMAX_DELAY);
+    }
+    taskENTER_CRITICAL(&_lock);
+    Job &job = _jobs[(_jobHead + _jobCount) % JOB_DEPTH];
+    job.buf = buf;
+    job.bufLen = pattern ? bufLen : total;
+    job.remaining = total;
+    job.fence = ++_fenceIssued;
+    job.pattern = pattern;
+    _jobCount++;
+    taskEXIT_CRITICAL(&_lock);
+    xTaskNotifyGive(_task);
+    return _fenceIssued;
+  }
+
+  static void completionTask(void *arg) {
+    ((ILI9486_DMABus *)arg)->serviceQueue();
+  }
+
+  // Completion task: top up the hardware queue, then wait for the oldest
+  // transaction to finish. Once everything is sent it ends a transaction
+  // the caller has already closed, then sleeps until there is more to send.
+  void serviceQueue() {
+    for (;;) {
+      refill();
+      if (_inFlight == 0) {
+        taskENTER_CRITICAL(&_lock);
+        bool release = _releasePending && _jobCount == 0;
+        if (release) _releasePending = false;
+        taskEXIT_CRITICAL(&_lock);
+        if (release) this->release();
+      }
+      xSemaphoreGive(_done);  // Fences or job slots may have moved on
+      if (_inFlight == 0) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        continue;
+      }
+      spi_transaction_t *done;
+      if (spi_device_get_trans_result(_dev, &done, portMAX_DELAY) != ESP_OK) continue;
+      _inFlight--;
+      ILI9486_Fence fence = (ILI9486_Fence)(uintptr_t)done->user;
+      if (fence) _fenceDone = fence;
+    }
+  }
+
+  void refill() {
+    while (_inFlight < QUEUE_DEPTH && _jobCount > 0) {
+      Job &job = _jobs[_jobHead];
+      uint32_t len = job.pattern ? job.bufLen : job.remaining;
+      if (len > job.remaining) len = job.remaining;
+      if (len > ILI9486_DMA_MAX_TRANSFER) len = ILI9486_DMA_MAX_TRANSFER;
+
+      spi_transaction_t &t = _trans[_next];
+      memset(&t, 0, sizeof(t));
+      t.length = len * 8;
+      t.tx_buffer = job.buf;
+      t.user = (len == job.remaining) ? (void *)(uintptr_t)job.fence : nullptr;
+      if (spi_device_queue_trans(_dev, &t, 0) != ESP_OK) break;
+
+      _next = (_next + 1) % QUEUE_DEPTH;
+      _inFlight++;
+      job.remaining -= len;
+      if (!job.pattern) job.buf += len;
+      if (job.remaining == 0) {
+        taskENTER_CRITICAL(&_lock);
+        _jobHead = (_jobHead + 1) % JOB_DEPTH;
+        _jobCount--;
+        taskEXIT_CRITICAL(&_lock);
+      }
+    }
+  }
+};
+
+#endif // ARDUINO_ARCH_ESP32
+
+#endif // ILI9486_BUS_H
@@ -2,212 +2,236 @@
 #define ILI9486_DISPLAY_H
 
 #include <Arduino.h>
-#include <SPI.h>
-
-// Helper macro for swapping values
-#ifndef swap
-#define swap(a, b) { typeof(a) t = a; a = b; b = t; }
-#endif
+#include <assert.h>
+#include "ILI9486_Bus.h"
+#include "ILI9486_Blob.h"
+#include "ILI9486_GFX.h"
+#include "ILI9486_Workers.h"
 
 // SPI host definition for ESP32-C5
 #ifndef SPI2_HOST
 #define SPI2_HOST 1
 #endif
 
-// Simple 5x7 font (ASCII 32-126)
-static const uint8_t font5x7[] PROGMEM = {
-  0x00, 0x00, 0x00, 0x00, 0x00, // (space)
-  0x00, 0x00, 0x5F, 0x00, 0x00, // !
-  0x00, 0x07, 0x00, 0x07, 0x00, // "
-  0x14, 0x7F, 0x14, 0x7F, 0x14, // #
-  0x24, 0x2A, 0x7F, 0x2A, 0x12, // $
-  0x23, 0x13, 0x08, 0x64, 0x62, // %
-  0x36, 0x49, 0x55, 0x22, 0x50, // &
-  0x00, 0x05, 0x03, 0x00, 0x00, // '
-  0x00, 0x1C, 0x22, 0x41, 0x00, // (
-  0x00, 0x41, 0x22, 0x1C, 0x00, // )
-  0x08, 0x2A, 0x1C, 0x2A, 0x08, // *
-  0x08, 0x08, 0x3E, 0x08, 0x08, // +
-  0x00, 0x50, 0x30, 0x00, 0x00, // ,
-  0x08, 0x08, 0x08, 0x08, 0x08, // -
-  0x00, 0x60, 0x60, 0x00, 0x00, // .
-  0x20, 0x10, 0x08, 0x04, 0x02, // /
-  0x3E, 0x51, 0x49, 0x45, 0x3E, // 0
-  0x00, 0x42, 0x7F, 0x40, 0x00, // 1
-  0x42, 0x61, 0x51, 0x49, 0x46, // 2
-  0x21, 0x41, 0x45, 0x4B, 0x31, // 3
-  0x18, 0x14, 0x12, 0x7F, 0x10, // 4
-  0x27, 0x45, 0x45, 0x45, 0x39, // 5
-  0x3C, 0x4A, 0x49, 0x49, 0x30, // 6
-  0x01, 0x71, 0x09, 0x05, 0x03, // 7
-  0x36, 0x49, 0x49, 0x49, 0x36, // 8
-  0x06, 0x49, 0x49, 0x29, 0x1E, // 9
-  0x00, 0x36, 0x36, 0x00, 0x00, // :
-  0x00, 0x56, 0x36, 0x00, 0x00, // ;
-  0x00, 0x08, 0x14, 0x22, 0x41, // <
-  0x14, 0x14, 0x14, 0x14, 0x14, // =
-  0x41, 0x22, 0x14, 0x08, 0x00, // >
-  0x02, 0x01, 0x51, 0x09, 0x06, // ?
-  0x32, 0x49, 0x79, 0x41, 0x3E, // @
-  0x7E, 0x11, 0x11, 0x11, 0x7E, // A
-  0x7F, 0x49, 0x49, 0x49, 0x36, // B
-  0x3E, 0x41, 0x41, 0x41, 0x22, // C
-  0x7F, 0x41, 0x41, 0x22, 0x1C, // D
-  0x7F, 0x49, 0x49, 0x49, 0x41, // E
-  0x7F, 0x09, 0x09, 0x01, 0x01, // F
-  0x3E, 0x41, 0x41, 0x51, 0x32, // G
-  0x7F, 0x08, 0x08, 0x08, 0x7F, // H
-  0x00, 0x41, 0x7F, 0x41, 0x00, // I
-  0x20, 0x40, 0x41, 0x3F, 0x01, // J
-  0x7F, 0x08, 0x14, 0x22, 0x41, // K
-  0x7F, 0x40, 0x40, 0x40, 0x40, // L
-  0x7F, 0x02, 0x04, 0x02, 0x7F, // M
-  0x7F, 0x04, 0x08, 0x10, 0x7F, // N
-  0x3E, 0x41, 0x41, 0x41, 0x3E, // O
-  0x7F, 0x09, 0x09, 0x09, 0x06, // P
-  0x3E, 0x41, 0x51, 0x21, 0x5E, // Q
-  0x7F, 0x09, 0x19, 0x29, 0x46, // R
-  0x46, 0x49, 0x49, 0x49, 0x31, // S
-  0x01, 0x01, 0x7F, 0x01, 0x01, // T
-  0x3F, 0x40, 0x40, 0x40, 0x3F, // U
-  0x1F, 0x20, 0x40, 0x20, 0x1F, // V
-  0x7F, 0x20, 0x18, 0x20, 0x7F, // W
-  0x63, 0x14, 0x08, 0x14, 0x63, // X
-  0x03, 0x04, 0x78, 0x04, 0x03, // Y
-  0x61, 0x51, 0x49, 0x45, 0x43, // Z
-  0x00, 0x00, 0x7F, 0x41, 0x41, // [
-  0x02, 0x04, 0x08, 0x10, 0x20, // backslash
-  0x41, 0x41, 0x7F, 0x00, 0x00, // ]
-  0x04, 0x02, 0x01, 0x02, 0x04, // ^
-  0x40, 0x40, 0x40, 0x40, 0x40, // _
-  0x00, 0x01, 0x02, 0x04, 0x00, // `
-  0x20, 0x54, 0x54, 0x54, 0x78, // a
-  0x7F, 0x48, 0x44, 0x44, 0x38, // b
-  0x38, 0x44, 0x44, 0x44, 0x20, // c
-  0x38, 0x44, 0x44, 0x48, 0x7F, // d
-  0x38, 0x54, 0x54, 0x54, 0x18, // e
-  0x08, 0x7E, 0x09, 0x01, 0x02, // f
-  0x0C, 0x52, 0x52, 0x52, 0x3E, // g
-  0x7F, 0x08, 0x04, 0x04, 0x78, // h
-  0x00, 0x44, 0x7D, 0x40, 0x00, // i
-  0x20, 0x40, 0x44, 0x3D, 0x00, // j
-  0x00, 0x7F, 0x10, 0x28, 0x44, // k
-  0x00, 0x41, 0x7F, 0x40, 0x00, // l
-  0x7C, 0x04, 0x18, 0x04, 0x78, // m
-  0x7C, 0x08, 0x04, 0x04, 0x78, // n
-  0x38, 0x44, 0x44, 0x44, 0x38, // o
-  0x7C, 0x14, 0x14, 0x14, 0x08, // p
-  0x08, 0x14, 0x14, 0x18, 0x7C, // q
-  0x7C, 0x08, 0x04, 0x04, 0x08, // r
-  0x48, 0x54, 0x54, 0x54, 0x20, // s
-  0x04, 0x3F, 0x44, 0x40, 0x20, // t
-  0x3C, 0x40, 0x40, 0x20, 0x7C, // u
-  0x1C, 0x20, 0x40, 0x20, 0x1C, // v
-  0x3C, 0x40, 0x30, 0x40, 0x3C, // w
-  0x44, 0x28, 0x10, 0x28, 0x44, // x
-  0x0C, 0x50, 0x50, 0x50, 0x3C, // y
-  0x44, 0x64, 0x54, 0x4C, 0x44, // z
+// Size in bytes of each of the two line buffers. Must hold at least one
+// full 480-pixel row (960 bytes); larger buffers mean fewer transfers.
+#ifndef ILI9486_LINE_BUFFER_SIZE
+#define ILI9486_LINE_BUFFER_SIZE 1024
+#endif
+
+// Tile size (pixels, square) for setTileFlush()
+#ifndef ILI9486_TILE_SIZE
+#define ILI9486_TILE_SIZE 16
+#endif
+
+// Fills up to this many bytes are written straight from the stack instead of
+// going through a line buffer (e.g. the short runs that make up text)
+#ifndef ILI9486_SMALL_FILL_BYTES
+#define ILI9486_SMALL_FILL_BYTES 32
+#endif
+
+// Without line buffers, larger fills are written from a stack buffer of this
+// many bytes, blocking until sent. It keeps a DMA transport from cutting a
+// big fill into thousands of tiny transactions.
+#ifndef ILI9486_FALLBACK_FILL_BYTES
+#define ILI9486_FALLBACK_FILL_BYTES 512
+#endif
+
+// Number of save-under regions that can be registered at once
+#ifndef ILI9486_SAVE_UNDERS
+#define ILI9486_SAVE_UNDERS 4
+#endif
+
+// Controller initialization sequence, sent with writeCommandData().
+// Format: command, parameter count (| INIT_DELAY if a delay byte follows), parameters..., [delay ms]
+// The table is terminated by a 0x00 command.
+#define INIT_DELAY 0x80
+static const uint8_t ili9486_init_cmds[] PROGMEM = {
+  0x01, INIT_DELAY,       120,  // Software reset
+  0x11, INIT_DELAY,       120,  // Sleep out
+  0x3A, 1,                0x55, // Pixel format: 16-bit color
+  0x36, 1,                0x08, // Memory access control: MX=0, MY=0, MV=0, ML=0, BGR=0 (RGB mode, not BGR)
+  0x29, INIT_DELAY,       50,   // Display on
+  0x00                          // End of table
 };
 
-// Color definitions (RGB565 format)
-#define TFT_BLACK       0x0000
-#define TFT_WHITE       0xFFFF
-#define TFT_RED         0xF800
-#define TFT_GREEN       0x07E0
-#define TFT_BLUE        0x001F
-#define TFT_CYAN        0x07FF
-#define TFT_MAGENTA     0xF81F
-#define TFT_YELLOW      0xFFE0
-#define TFT_ORANGE      0xFD20
-#define TFT_GREENYELLOW 0xAFE5
-#define TFT_DARKGREY    0x7BEF
-#define TFT_LIGHTGREY   0xC618
-
-// Text datum definitions (Bodmer TFT_eSPI compatible)
-#define TL_DATUM 0  // Top Left
-#define TC_DATUM 1  // Top Center
-#define TR_DATUM 2  // Top Right
-#define ML_DATUM 3  // Middle Left
-#define MC_DATUM 4  // Middle Center
-#define MR_DATUM 5  // Middle Right
-#define BL_DATUM 6  // Bottom Left (baseline)
-#define BC_DATUM 7  // Bottom Center
-#define BR_DATUM 8  // Bottom Right
-
-// GFX font structures (Adafruit GFX format)
-typedef struct {
-  uint16_t bitmapOffset;     // Pointer into GFXfont->bitmap
-  uint8_t  width, height;    // Bitmap dimensions in pixels
-  uint8_t  xAdvance;         // Distance to advance cursor (x axis)
-  int8_t   xOffset, yOffset; // Dist from cursor pos to UL corner
-} GFXglyph;
-
-typedef struct {
-  uint8_t  *bitmap;      // Glyph bitmaps, concatenated
-  GFXglyph *glyph;       // Glyph array
-  uint8_t   first, last; // ASCII extents
-  uint8_t   yAdvance;    // Newline distance (y axis)
-} GFXfont;
-
-class ILI9486_Display {
+// Display driver, specialized at compile time on its bus transport.
+// Bus is ILI9486_SPIBus<Pins> for real hardware (see ILI9486_Bus.h) or
+// ILI9486_HostBus for desktop builds (see ILI9486_HostBus.h).
+// The shape, text and bitmap algorithms come from ILI9486_GFX and draw
+// through fillRect()/drawPixel()/pushRows() below.
+template <class Bus>
+class ILI9486_Driver : public ILI9486_GFX<ILI9486_Driver<Bus> > {
 private:
-  int8_t _cs, _dc, _rst;
-  int8_t _mosi, _sclk;
+  typedef ILI9486_GFX<ILI9486_Driver<Bus> > GFX;
+  
+  Bus _bus;
+  uint8_t _writeDepth;      // startWrite() nesting depth, CS is low while > 0
   uint16_t _width, _height;
   uint8_t _rotation;
   
+  // Shadow of controller state, used to skip redundant register writes
+  uint16_t _winX0, _winX1;  // Last CASET bounds (0xFFFF = unknown)
+  uint16_t _winY0, _winY1;  // Last RASET bounds (0xFFFF = unknown)
+  uint8_t _madctl;          // Last MADCTL value
+  uint8_t _colmod;          // Last COLMOD value
+  bool _regsValid;          // MADCTL/COLMOD shadow valid
+  
   void writeCommand(uint8_t cmd);
+  void writeCommandData(uint8_t cmd, const uint8_t *data, uint8_t len);
+  void sendCommand(uint8_t cmd, const uint8_t *data, uint8_t len);
   void writeData(uint8_t data);
   void writeData16(uint16_t data);
   void writeData32(uint32_t data);
   void setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
   
 public:
-  ILI9486_Display(int8_t cs, int8_t dc, int8_t rst, int8_t mosi, int8_t sclk);
+  explicit ILI9486_Driver(const Bus &bus);
+  ~ILI9486_Driver();
+  ILI9486_Driver(const ILI9486_Driver &) = delete;
+  ILI9486_Driver &operator=(const ILI9486_Driver &) = delete;
   
   void begin(uint32_t freq = 27000000);  // default.  Try changing to lower speed if problems show up.
   void setRotation(uint8_t rotation);
-  void fillScreen(uint16_t color);
+  
+  // Transaction batching - CS stays low from the outermost startWrite() to its endWrite()
+  void startWrite();
+  void endWrite();
+  bool inTransaction() { return _writeDepth > 0; }
+  
+  // Forget the cached window/MADCTL/COLMOD state so the next calls send it
+  // again (e.g. after something else wrote to the panel, or before recording a blob)
+  void invalidateShadow();
+  
   void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
-  void drawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
   void drawPixel(uint16_t x, uint16_t y, uint16_t color);
-  void drawLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color);
-  void drawFastHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color);
-  void drawFastVLine(uint16_t x, uint16_t y, uint16_t h, uint16_t color);
+  
+  // Recorded as one display list op each while a list is being recorded,
+  // otherwise drawn by ILI9486_GFX
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
   void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
   void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
-  
-  // Bitmap drawing
   void drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
   void drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg);
-  
-  // Font rendering
-  void setFreeFont(const GFXfont *f = NULL);
-  void setCursor(uint16_t x, uint16_t y);
-  void setTextColor(uint16_t color);
-  void setTextColor(uint16_t fg, uint16_t bg);
-  void setTextSize(uint8_t s);
-  void setTextDatum(uint8_t datum);
-  void print(const char *str);
-  void print(int num);
-  void print(unsigned long num);
-  void print(float num, int decimals = 2);
-  void println(const char *str);
-  void println(int num);
   void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
   void drawGFXChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
-  
-  // String drawing with positioning
-  int16_t drawString(const String &string, int32_t x, int32_t y, uint8_t font = 0);
-  int16_t drawCentreString(const char *string, int32_t x, int32_t y, uint8_t font = 0);
-  
-  // Color conversion
-  uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
-    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-  }
-  
-  // DMA optimized fills
-  void fillRectDMA(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+  void pushImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *data);
+  
+  // Low-level pixel streaming. setWindow() selects the target area (inclusive
+  // corners) and starts a memory write; pushBlock()/pushPixels() then fill it
+  // left to right, top to bottom. Wrap a sequence in startWrite()/endWrite()
+  // so CS stays low between the calls.
+  void setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+  void pushBlock(uint16_t color, uint32_t len);
+  void pushPixels(const uint16_t *data, uint32_t len, bool swapBytes = true);  // swapBytes = false: data already in panel byte order
+  
+  // Stream a w x h block, clipped to the screen, whose pixels are produced on
+  // the fly: renderRow(dst, row, col, count) writes count big-endian RGB565
+  // pixels of block row "row" starting at block column "col" straight into
+  // the outgoing line buffer (e.g. palette expansion of an indexed sprite).
+  template <class RowFn>
+  void pushRows(int16_t x, int16_t y, int16_t w, int16_t h, RowFn renderRow);
+  
+  // Asynchronous (DMA) transfers. These return as soon as the data is queued;
+  // the returned fence can be polled with dmaDone() or waited on with waitDMA().
+  // The CPU is free to prepare the next region while the current one is sent.
+  ILI9486_Fence fillRectDMA(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+  ILI9486_Fence pushImageDMA(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *data);  // data in panel byte order, kept valid until done
+  bool dmaBusy();
+  bool dmaDone(ILI9486_Fence fence) { return _bus.fenceDone(fence); }
+  void waitDMA();
+  void waitDMA(ILI9486_Fence fence);
+  
+  // Display lists (banded rendering). Between beginList() and endList() the
+  // drawing primitives are recorded instead of drawn. renderList() then
+  // replays them once per band of bandRows rows into a RAM strip and sends
+  // each strip as one memory write: flicker-free, overdraw-free output
+  // without a full frame buffer. Bitmaps, images and fonts are referenced,
+  // not copied, and must stay valid until rendered. setWindow()/pushBlock()/
+  // pushPixels()/pushRows()/pushBlob() are ignored while recording.
+  bool beginList(uint16_t maxOps = 256);
+  bool endList();                    // False if ops were dropped (list full)
+  bool renderList(uint16_t bg = TFT_BLACK, uint16_t bandRows = 32);
+  void freeList();                   // Release list and strip memory
+  bool recording() { return _drawMode == DRAW_RECORD; }
+  
+  // Render list bands on worker threads as well (up to
+  // ILI9486_MAX_RENDER_THREADS; on the ESP32 they run on the other core).
+  // Bands are rendered in parallel, each into its own strip, while the
+  // calling thread keeps the bus and sends them in order; it renders too
+  // while it waits. Every worker costs one more strip. Returns false where
+  // threads are not available (ILI9486_THREADS is 0, the Arduino default).
+  bool setRenderThreads(uint8_t threads);
+  uint8_t renderThreads() { return _workers.threads(); }
+  
+  // Deferred drawing. Between beginDeferred() and endDeferred() draw calls
+  // are recorded (in the display list) instead of drawn, and optimized
+  // before anything is sent: ops that a later fill, image, opaque bitmap or
+  // opaque character covers are dropped, fills that are partly covered are
+  // trimmed, fills of one color that share an edge become one window, and
+  // ops that do not overlap are reordered so consecutive windows share
+  // their columns or rows. The result looks the same as drawing directly.
+  // A full buffer is drawn and emptied instead of dropping ops.
+  // setWindow()/pushBlock()/pushPixels()/pushRows()/pushBlob() and the list
+  // functions end the deferred frame first.
+  bool beginDeferred(uint16_t maxOps = 256);
+  void endDeferred();                // Optimize and draw what was recorded
+  bool deferring() { return _deferred; }
+  
+  // Full-frame canvas: a frame buffer in RAM (PSRAM when available) with its
+  // own drawing target, canvas(). The areas drawn into it are tracked and
+  // flush() sends only those, merging nearby areas when one window is
+  // cheaper than two. The driver itself keeps drawing to the panel.
+  bool beginCanvas();                // Allocate the frame, false if out of memory
+  
+  // 1-bit canvas: 19.2 KB instead of 300 KB. Pixels drawn in the background
+  // color clear a bit, any other color sets it; flush() expands the bits to
+  // fg/bg while filling the line buffers. Switching between this and
+  // beginCanvas() reallocates the frame.
+  bool beginMonoCanvas(uint16_t fg = TFT_WHITE, uint16_t bg = TFT_BLACK);
+  void setMonoColors(uint16_t fg, uint16_t bg);  // Recolors the whole frame on the next flush()
+  ILI9486_RamCanvas &canvas() { return _canvas; }
+  void flush();                      // Send the dirty areas to the panel
+  void freeCanvas();
+  
+  // Tile-hash flush: flush() hashes each ILI9486_TILE_SIZE tile inside the
+  // dirty areas and sends only tiles whose contents differ from what was
+  // last sent, joining neighbours in a tile row into one window. Catches
+  // areas that were redrawn with the same pixels. False if out of memory.
+  bool setTileFlush(bool enable);
+  
+  // Shadow of panel memory. The panel cannot be read back over this wiring
+  // (no MISO), so while the mirror is on every pixel sent to the panel is
+  // also stored in RAM, which makes readPixel()/readRect() and
+  // read-modify-write effects (blending, XOR cursors) possible. The full
+  // mirror costs width x height x 2 bytes (PSRAM when available); the compact
+  // one keeps a row that is one solid color as just that color and only
+  // allocates rows with detail. It starts black and is kept in the panel's
+  // own orientation, so it survives rotation changes. Returns false if out
+  // of memory.
+  bool beginMirror(bool compact = false);
+  void endMirror();
+  bool mirrorActive() { return _mirror != nullptr; }
+  
+  // Read back RGB565 pixels from the mirror (0 without one)
+  uint16_t readPixel(uint16_t x, uint16_t y);
+  void readRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *data);
+  
+  // Save-under regions for popups, menus and toasts. While a region is
+  // capturing, every pixel sent to the panel inside it is also copied into
+  // the region's buffer. Suspend it while the popup is drawn on top, and
+  // restoreSaveUnder() puts the pixels underneath back with one window
+  // instead of redrawing the screen below. The buffer starts from the mirror
+  // when there is one, otherwise black. Returns the region id, or -1 if out
+  // of memory or all ILI9486_SAVE_UNDERS slots are in use.
+  int8_t addSaveUnder(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void suspendSaveUnder(int8_t id);  // Stop capturing (draw the popup)
+  void restoreSaveUnder(int8_t id);  // Send the saved pixels, capture again
+  void removeSaveUnder(int8_t id);
+  
+  // Replay a precompiled screen (see ILI9486_Blob.h). The blob may live in
+  // flash. Returns false if it is not a valid blob.
+  bool pushBlob(const uint8_t *blob);
   
   // WiFi icon
   void drawWiFiIcon(uint16_t x, uint16_t y, uint8_t strength, uint16_t color);
@@ -215,761 +239,1893 @@ public:
   uint16_t width() { return _width; }
   uint16_t height() { return _height; }
   
-  // Font array for indexed font selection (public for user configuration)
-  const GFXfont* fontArray[6];  // Indices: 0=current, 1=builtin, 2-5=user fonts
+  // Line buffer size in bytes (two are allocated from DMA-capable memory).
+  // begin() allocates ILI9486_LINE_BUFFER_SIZE unless this was called first.
+  // Returns false if the memory is not available.
+  bool setBufferSize(size_t bytes);
+  size_t bufferSize() { return lineBuf[0].data ? lineBufferSize : 0; }
+  
+  // Underlying transport (e.g. to read ILI9486_HostBus statistics)
+  Bus &bus() { return _bus; }
   
 private:
-  const GFXfont *gfxFont;
-  uint16_t cursor_x, cursor_y;
-  uint16_t textcolor, textbgcolor;
-  uint8_t textsize;
-  uint8_t textdatum;
-  bool use_bg;
-  
-  // DMA buffer for faster transfers  
-  static const size_t DMA_BUFFER_SIZE = 1024; // 1024 bytes = 512 pixels in 16-bit mode
-  uint8_t dmaBuffer[DMA_BUFFER_SIZE];
-  
-  void writePixels(uint16_t *colors, uint32_t len);
+  static const uint16_t MAX_WIDTH = 480;  // Widest row in any rotation
+  static const uint16_t PANEL_WIDTH = 320, PANEL_HEIGHT = 480;  // Controller memory (rotation 0)
+  
+  // Line buffer pipeline: the CPU rasterizes the next band into one buffer
+  // while the previous band is still being clocked out of the other. The
+  // buffers are heap allocated from DMA-capable memory, so it does not matter
+  // where the driver object itself lives.
+  static const uint8_t LINE_BUFFERS = 2;
+  static const size_t MIN_LINE_BUFFER_SIZE = MAX_WIDTH * 2;  // One full row
+  struct LineBuffer {
+    uint8_t *data;
+    ILI9486_Fence fence;    // Last queued transfer reading this buffer
+    uint16_t fillColor;     // Color repeated over the first fillBytes bytes
+    uint32_t fillBytes;     // 0 when the buffer holds anything else
+  };
+  LineBuffer lineBuf[LINE_BUFFERS];
+  size_t lineBufferSize;
+  uint8_t lineNext;
+  
+  void freeLineBuffers();
+  uint8_t acquireLineBuffer();
+  uint8_t colorBuffer(uint16_t color, uint32_t fillBytes);
+  ILI9486_Fence queueFill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+  void writeFill(uint16_t color, uint32_t totalBytes);
+  
+  // Drawing target. In DRAW_RECORD mode the primitives append a display
+  // list op and return.
+  enum { DRAW_PANEL, DRAW_RECORD };
+  enum { OP_FILL, OP_PIXEL, OP_LINE, OP_CIRCLE, OP_FILL_CIRCLE, OP_BITMAP, OP_BITMAP_BG, OP_CHAR, OP_IMAGE };
+  struct ListOp {
+    uint8_t type;
+    uint8_t size;           // Text size (OP_CHAR)
+    uint8_t c;              // Character (OP_CHAR)
+    bool opaque;            // Text background (OP_CHAR)
+    int16_t top, bottom;    // Rows touched, for skipping ops outside a band
+    int16_t v[4];           // Coordinates, as passed to the primitive
+    uint16_t color, bg;
+    const void *ptr;        // Bitmap, image or font
+  };
+  uint8_t _drawMode;
+  ListOp *_list;
+  uint16_t _listCap, _listLen;
+  bool _listOverflow;
+  bool _deferred;           // The list is a deferred frame
+  
+  // Screen area an op can touch (inclusive), for the deferred optimizer
+  struct OpBox {
+    uint16_t x0, y0, x1, y1;
+    bool solid;             // Every pixel is painted, as one window
+    bool live;
+  };
+  static const uint8_t REORDER_LOOKAHEAD = 16;
+  // List strips, panel byte order: one on the wire, one for the calling
+  // thread and one per render worker
+  static const uint8_t MAX_STRIPS = ILI9486_MAX_RENDER_THREADS + 2;
+  uint8_t *_strip[MAX_STRIPS];
+  ILI9486_Fence _stripFence[MAX_STRIPS];
+  uint8_t _stripCount;
+  size_t _stripBytes;       // Allocated size of each strip
+  ILI9486_BandWorkers _workers;
+  
+  // What renderBand() needs, shared with the render workers
+  struct BandJob {
+    const ListOp *list;
+    uint16_t listLen;
+    uint8_t *const *strip;
+    uint8_t strips;
+    uint16_t width, height, bandRows;
+    uint16_t bg;
+  };
+  
+  // Canvas frame and the areas drawn into it since the last flush()
+  static const uint16_t MAX_TILE_COLS = (MAX_WIDTH + ILI9486_TILE_SIZE - 1) / ILI9486_TILE_SIZE;
+  ILI9486_RamCanvas _canvas;
+  uint8_t *_canvasBuf;
+  uint16_t _monoColors[2];  // Palette of the 1-bit canvas: bg, fg
+  ILI9486_DirtySet _dirty;
+  uint32_t *_tileHash;      // Hash of each tile as last sent, row-major
+  uint16_t _tileCols;       // Tile grid width the hashes were taken with
+  bool _tilesValid;         // _tileHash matches the panel
+  
+  // Panel memory mirror, one entry per row of controller memory. Pixels
+  // written in other rotations are mapped back to rotation 0.
+  struct MirrorRow {
+    uint8_t *px;            // Pixels in panel byte order, nullptr while the row is one color
+    uint16_t color;         // Color of a solid row (compact mirror)
+  };
+  MirrorRow *_mirror;
+  uint8_t *_mirBlock;       // Pixels of the full mirror
+  bool _mirCompact;
+  uint16_t _mirX0, _mirX1, _mirY0, _mirY1;  // Memory write window
+  uint16_t _mirX, _mirY;    // Write pointer
+  bool _mirOdd;             // Holding the first byte of a pixel
+  uint8_t _mirByte;
+  
+  bool _capturing;          // Mirror or a save-under region watches pixel writes
+  
+  struct SaveUnder {
+    uint8_t *px;            // w x h pixels, panel byte order; nullptr = free slot
+    uint16_t x, y, w, h;
+    bool capturing;
+  };
+  SaveUnder _saveUnder[ILI9486_SAVE_UNDERS];
+  
+  void updateCapturing();
+  void mirrorReset();
+  void mirrorWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+  void mirrorBytes(const uint8_t *data, uint32_t len);
+  void mirrorPixels(const uint8_t *src, uint16_t color, uint32_t count);
+  void mirrorSpan(uint16_t x, uint16_t y, uint16_t n, const uint8_t *src);
+  void mirrorFill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+  void mirrorRow(uint16_t y, uint16_t x, uint16_t n, const uint8_t *src, uint16_t color);
+  uint16_t mirrorRead(uint16_t x, uint16_t y);
+  
+  ListOp *listAdd(uint8_t type, int16_t top, int16_t bottom);
+  void freeStrips();
+  void flushDeferred();
+  void optimizeList();
+  bool opBox(const ListOp &op, OpBox &b);
+  bool streamIgnored();
+  static bool boxOverlap(const OpBox &a, const OpBox &b) {
+    return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+  }
+  static bool boxAdjacent(const OpBox &a, const OpBox &b) {
+    return (a.x0 == b.x0 && a.x1 == b.x1 && (a.y1 + 1 == b.y0 || b.y1 + 1 == a.y0)) ||
+           (a.y0 == b.y0 && a.y1 == b.y1 && (a.x1 + 1 == b.x0 || b.x1 + 1 == a.x0));
+  }
+  static void renderBand(void *job, uint16_t band);
+  template <class Target>
+  static void replayOp(Target &t, const ListOp &op);
+  bool allocCanvas(uint8_t bpp);
+  void dirtyAll();
+  void flushTiles();
+  uint32_t tileHash(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
 };
 
 // Constructor
-ILI9486_Display::ILI9486_Display(int8_t cs, int8_t dc, int8_t rst, int8_t mosi, int8_t sclk) {
-  _cs = cs;
-  _dc = dc;
-  _rst = rst;
-  _mosi = mosi;
-  _sclk = sclk;
+template <class Bus>
+ILI9486_Driver<Bus>::ILI9486_Driver(const Bus &bus) : _bus(bus) {
+  _writeDepth = 0;
+  lineBufferSize = ILI9486_LINE_BUFFER_SIZE;
+  lineNext = 0;
+  for (uint8_t i = 0; i < LINE_BUFFERS; i++) {
+    lineBuf[i].data = nullptr;
+    lineBuf[i].fence = 0;
+    lineBuf[i].fillBytes = 0;
+  }
   _width = 320;
   _height = 480;
   _rotation = 0;
-  gfxFont = nullptr;
-  cursor_x = 0;
-  cursor_y = 0;
-  textcolor = TFT_WHITE;
-  textbgcolor = TFT_BLACK;
-  textsize = 1;
-  textdatum = TL_DATUM;  // Default to Top-Left
-  use_bg = false;
-  
-  // Initialize font array
-  for (int i = 0; i < 6; i++) {
-    fontArray[i] = nullptr;
+  invalidateShadow();
+  
+  _drawMode = DRAW_PANEL;
+  _list = nullptr;
+  _listCap = _listLen = 0;
+  _listOverflow = false;
+  _deferred = false;
+  _stripCount = 0;
+  _stripBytes = 0;
+  _canvasBuf = nullptr;
+  _monoColors[0] = TFT_BLACK;
+  _monoColors[1] = TFT_WHITE;
+  _canvas.trackDirty(&_dirty);
+  _tileHash = nullptr;
+  _tileCols = 0;
+  _tilesValid = false;
+  _mirror = nullptr;
+  _mirBlock = nullptr;
+  _capturing = false;
+  mirrorWindow(0, 0, _width - 1, _height - 1);  // Until the first window is set
+  for (uint8_t i = 0; i < ILI9486_SAVE_UNDERS; i++) {
+    _saveUnder[i].px = nullptr;
+  }
+}
+
+template <class Bus>
+ILI9486_Driver<Bus>::~ILI9486_Driver() {
+  freeList();
+  freeCanvas();
+  endMirror();
+  for (int8_t i = 0; i < ILI9486_SAVE_UNDERS; i++) {
+    removeSaveUnder(i);
   }
+  freeLineBuffers();
 }
 
 // Initialize display
-void ILI9486_Display::begin(uint32_t freq) {
-  pinMode(_cs, OUTPUT);
-  pinMode(_dc, OUTPUT);
-  pinMode(_rst, OUTPUT);
-  
-  digitalWrite(_cs, HIGH);
-  digitalWrite(_dc, HIGH);
-  
-  // Initialize SPI using the standard SPI object (not SPIClass)
-  SPI.begin(_sclk, -1, _mosi, -1);
-  SPI.setFrequency(freq);
-  SPI.setDataMode(SPI_MODE0);
-  SPI.setBitOrder(MSBFIRST);
+template <class Bus>
+void ILI9486_Driver<Bus>::begin(uint32_t freq) {
+  // Bring up the transport; clock, mode and bit order are applied per transaction
+  _bus.begin(freq);
+  _writeDepth = 0;
+  
+  // Line buffers, falling back to smaller ones if memory is tight
+  if (!lineBuf[0].data) {
+    size_t size = lineBufferSize;
+    while (!setBufferSize(size) && size > MIN_LINE_BUFFER_SIZE) {
+      size /= 2;
+    }
+  }
   
   // Hardware reset
-  digitalWrite(_rst, LOW);
-  delay(20);
-  digitalWrite(_rst, HIGH);
-  delay(150);
+  _bus.hardwareReset();
   
-  // Minimal ILI9486 initialization - matches working sketch
-  writeCommand(0x01); // Software reset
-  delay(120);
-  
-  writeCommand(0x11); // Sleep out
-  delay(120);
-  
-  writeCommand(0x3A); // Pixel format
-  writeData(0x55);    // 16-bit color
+  // Controller state is unknown until the init sequence has been sent
+  invalidateShadow();
   
-  writeCommand(0x36); // Memory access control
-  writeData(0x08);    // MX=0, MY=0, MV=0, ML=0, BGR=0 (RGB mode, not BGR)
-  
-  writeCommand(0x29); // Display on
-  delay(50);
+  // Minimal ILI9486 initialization - matches working sketch
+  const uint8_t *addr = ili9486_init_cmds;
+  uint8_t cmd;
+  while ((cmd = pgm_read_byte(addr++)) != 0x00) {
+    uint8_t numArgs = pgm_read_byte(addr++);
+    bool hasDelay = numArgs & INIT_DELAY;
+    numArgs &= ~INIT_DELAY;
+    
+    uint8_t params[16];
+    for (uint8_t i = 0; i < numArgs; i++) {
+      params[i] = pgm_read_byte(addr++);
+    }
+    writeCommandData(cmd, params, numArgs);
+    
+    if (hasDelay) {
+      delay(pgm_read_byte(addr++));
+    }
+  }
   
-  fillScreen(TFT_BLACK);
+  this->fillScreen(TFT_BLACK);
+}
+
+// Begin a write transaction. Nested calls only bump the depth counter, so
+// primitives can batch freely and the bus is claimed exactly once.
+template <class Bus>
+void ILI9486_Driver<Bus>::startWrite() {
+  if (_writeDepth++ == 0) {
+    _bus.beginTransaction();
+  }
+}
+
+// End a write transaction when the outermost one ends. Data still queued
+// keeps CS low until it has been sent; the transport then releases CS and
+// the bus by itself, so endWrite() never waits for it.
+template <class Bus>
+void ILI9486_Driver<Bus>::endWrite() {
+  if (_writeDepth == 0) return;
+  if (--_writeDepth == 0) {
+    _bus.endTransaction();
+  }
+}
+
+template <class Bus>
+bool ILI9486_Driver<Bus>::dmaBusy() {
+  return _bus.busy();
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::waitDMA() {
+  _bus.waitIdle();
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::waitDMA(ILI9486_Fence fence) {
+  _bus.waitFence(fence);
 }
 
 // Low-level write functions
-void ILI9486_Display::writeCommand(uint8_t cmd) {
-  digitalWrite(_dc, LOW);
-  digitalWrite(_cs, LOW);
-  SPI.transfer(cmd);
-  digitalWrite(_cs, HIGH);
+template <class Bus>
+void ILI9486_Driver<Bus>::writeCommand(uint8_t cmd) {
+  startWrite();
+  _bus.writeCommand(cmd);
+  endWrite();
+}
+
+// Forget everything we know about controller registers (after reset)
+template <class Bus>
+void ILI9486_Driver<Bus>::invalidateShadow() {
+  _winX0 = _winX1 = 0xFFFF;
+  _winY0 = _winY1 = 0xFFFF;
+  _madctl = 0;
+  _colmod = 0;
+  _regsValid = false;
 }
 
-void ILI9486_Display::writeData(uint8_t data) {
-  digitalWrite(_dc, HIGH);
-  digitalWrite(_cs, LOW);
-  SPI.transfer(data);
-  digitalWrite(_cs, HIGH);
+// Send a command followed by its parameter block inside a single CS assertion
+template <class Bus>
+void ILI9486_Driver<Bus>::writeCommandData(uint8_t cmd, const uint8_t *data, uint8_t len) {
+  startWrite();
+  sendCommand(cmd, data, len);
+  endWrite();
+  
+  // Keep the register shadow in step with what the controller has seen
+  if (cmd == 0x01) {
+    invalidateShadow();
+  } else if (cmd == 0x36 && len > 0) {
+    _madctl = data[0];
+    _regsValid = true;
+  } else if (cmd == 0x3A && len > 0) {
+    _colmod = data[0];
+  }
+}
+
+// Command byte + parameter block, caller must hold CS low
+template <class Bus>
+void ILI9486_Driver<Bus>::sendCommand(uint8_t cmd, const uint8_t *data, uint8_t len) {
+  _bus.writeCommand(cmd);
+  if (len > 0) {
+    _bus.writeBytes(data, len);
+  }
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::writeData(uint8_t data) {
+  startWrite();
+  _bus.write(data);
+  endWrite();
 }
 
-void ILI9486_Display::writeData16(uint16_t data) {
-  digitalWrite(_dc, HIGH);
-  digitalWrite(_cs, LOW);
-  SPI.transfer(data >> 8);
-  SPI.transfer(data & 0xFF);
-  digitalWrite(_cs, HIGH);
+template <class Bus>
+void ILI9486_Driver<Bus>::writeData16(uint16_t data) {
+  startWrite();
+  _bus.write16(data);
+  endWrite();
 }
 
-void ILI9486_Display::writeData32(uint32_t data) {
-  digitalWrite(_dc, HIGH);
-  digitalWrite(_cs, LOW);
-  SPI.transfer((data >> 24) & 0xFF);
-  SPI.transfer((data >> 16) & 0xFF);
-  SPI.transfer((data >> 8) & 0xFF);
-  SPI.transfer(data & 0xFF);
-  digitalWrite(_cs, HIGH);
+template <class Bus>
+void ILI9486_Driver<Bus>::writeData32(uint32_t data) {
+  startWrite();
+  _bus.write16(data >> 16);
+  _bus.write16(data & 0xFFFF);
+  endWrite();
 }
 
-// Set drawing window
-void ILI9486_Display::setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
-  writeCommand(0x2A); // Column address
-  writeData(x0 >> 8);
-  writeData(x0 & 0xFF);
-  writeData(x1 >> 8);
-  writeData(x1 & 0xFF);
+// Set drawing window - CASET, RASET and RAMWR framed in one CS assertion.
+// Column/row bounds that match the shadow are not re-sent, e.g. a vertical
+// run in the same column only sends RASET.
+template <class Bus>
+void ILI9486_Driver<Bus>::setAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+  startWrite();
+  
+  if (x0 != _winX0 || x1 != _winX1) {
+    uint8_t col[4] = { (uint8_t)(x0 >> 8), (uint8_t)(x0 & 0xFF), (uint8_t)(x1 >> 8), (uint8_t)(x1 & 0xFF) };
+    sendCommand(0x2A, col, 4);   // Column address
+    _winX0 = x0;
+    _winX1 = x1;
+  }
   
-  writeCommand(0x2B); // Row address
-  writeData(y0 >> 8);
-  writeData(y0 & 0xFF);
-  writeData(y1 >> 8);
-  writeData(y1 & 0xFF);
+  if (y0 != _winY0 || y1 != _winY1) {
+    uint8_t row[4] = { (uint8_t)(y0 >> 8), (uint8_t)(y0 & 0xFF), (uint8_t)(y1 >> 8), (uint8_t)(y1 & 0xFF) };
+    sendCommand(0x2B, row, 4);   // Row address
+    _winY0 = y0;
+    _winY1 = y1;
+  }
   
-  writeCommand(0x2C); // Memory write
+  sendCommand(0x2C, nullptr, 0); // Memory write (always, resets the write pointer)
+  if (_capturing) mirrorWindow(x0, y0, x1, y1);
+  endWrite();
 }
 
 // Set rotation
-void ILI9486_Display::setRotation(uint8_t rotation) {
+template <class Bus>
+void ILI9486_Driver<Bus>::setRotation(uint8_t rotation) {
+  bool rotated = rotation % 4 != _rotation;
   _rotation = rotation % 4;
-  writeCommand(0x36);
+  uint8_t madctl = 0x48;
   
   switch (_rotation) {
     case 0:
-      writeData(0x48);
+      madctl = 0x48;
       _width = 320;
       _height = 480;
       break;
     case 1:
-      writeData(0x28);
+      madctl = 0x28;
       _width = 480;
       _height = 320;
       break;
     case 2:
-      writeData(0x88);
+      madctl = 0x88;
       _width = 320;
       _height = 480;
       break;
     case 3:
-      writeData(0xE8);
+      madctl = 0xE8;
       _width = 480;
       _height = 320;
       break;
   }
+  
+  // The canvas takes the new shape (same bytes); dirty areas were in the old
+  // orientation, so the whole canvas is resent
+  if (_canvasBuf && rotated) {
+    _canvas.setBuffer(_canvasBuf, _width, _height);
+    dirtyAll();
+  }
+  
+  // Skip MADCTL if the controller already has this orientation
+  if (_regsValid && madctl == _madctl) return;
+  writeCommandData(0x36, &madctl, 1);
 }
 
-// Fill screen
-void ILI9486_Display::fillScreen(uint16_t color) {
-  fillRect(0, 0, _width, _height, color);
+// Fill rectangle - Full DMA optimization at 27MHz (sweet spot for this display)
+template <class Bus>
+void ILI9486_Driver<Bus>::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+  if (_drawMode == DRAW_RECORD) {
+    ListOp *op = listAdd(OP_FILL, y, y + h - 1);
+    if (op) {
+      op->v[0] = x; op->v[1] = y; op->v[2] = w; op->v[3] = h;
+      op->color = color;
+    }
+    return;
+  }
+  startWrite();
+  queueFill(x, y, w, h, color);
+  endWrite();
 }
 
-// Fill rectangle - Full DMA optimization at 27MHz (sweet spot for this display)
-void ILI9486_Display::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
-  if (x >= _width || y >= _height) return;
+// DMA fill - queues the pixel data and returns without waiting for it to be sent
+template <class Bus>
+ILI9486_Fence ILI9486_Driver<Bus>::fillRectDMA(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+  if (_drawMode == DRAW_RECORD) {
+    fillRect(x, y, w, h, color);
+    return 0;
+  }
+  startWrite();
+  ILI9486_Fence fence = queueFill(x, y, w, h, color);
+  endWrite();
+  return fence;
+}
+
+// (Re)allocate the line buffers. Anything still reading the old ones is
+// allowed to finish first.
+template <class Bus>
+bool ILI9486_Driver<Bus>::setBufferSize(size_t bytes) {
+  if (bytes < MIN_LINE_BUFFER_SIZE) bytes = MIN_LINE_BUFFER_SIZE;
+  bytes &= ~(size_t)1;  // Whole pixels only
+  
+  freeLineBuffers();
+  lineBufferSize = bytes;
+  for (uint8_t i = 0; i < LINE_BUFFERS; i++) {
+    lineBuf[i].data = (uint8_t *)ili9486_dma_alloc(bytes);
+    if (!lineBuf[i].data) {
+      freeLineBuffers();
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::freeLineBuffers() {
+  for (uint8_t i = 0; i < LINE_BUFFERS; i++) {
+    if (lineBuf[i].data) {
+      _bus.waitFence(lineBuf[i].fence);
+      ili9486_dma_free(lineBuf[i].data);
+      lineBuf[i].data = nullptr;
+    }
+    lineBuf[i].fence = 0;
+    lineBuf[i].fillBytes = 0;
+  }
+}
+
+// Take the oldest line buffer, waiting for its previous transfer to finish
+template <class Bus>
+uint8_t ILI9486_Driver<Bus>::acquireLineBuffer() {
+  uint8_t idx = lineNext;
+  lineNext = (lineNext + 1) % LINE_BUFFERS;
+  _bus.waitFence(lineBuf[idx].fence);
+  return idx;
+}
+
+// Clip and queue a solid fill through the line buffer pipeline. Tiny fills
+// are written directly from the stack. A buffer that already holds enough of
+// the color is sent again as is (it is only read, so it can be queued while
+// still in flight); otherwise the oldest buffer is filled before the window
+// is set, so that work overlaps the previous transfer. Caller holds the
+// transaction.
+template <class Bus>
+ILI9486_Fence ILI9486_Driver<Bus>::queueFill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+  if (x >= _width || y >= _height) return 0;
   if (x + w > _width) w = _width - x;
   if (y + h > _height) h = _height - y;
+  if (w == 0 || h == 0) return 0;
   
-  setAddrWindow(x, y, x + w - 1, y + h - 1);
-  
-  // Prepare color bytes
-  uint8_t hi = color >> 8;
-  uint8_t lo = color & 0xFF;
+  uint32_t totalBytes = (uint32_t)w * h * 2;
   
-  // Fill DMA buffer with repeated color
-  for (uint16_t i = 0; i < DMA_BUFFER_SIZE; i += 2) {
-    dmaBuffer[i] = hi;
-    dmaBuffer[i + 1] = lo;
+  // Tiny fill, or no line buffers: send from the stack
+  if (totalBytes <= ILI9486_SMALL_FILL_BYTES || !lineBuf[0].data) {
+    setAddrWindow(x, y, x + w - 1, y + h - 1);
+    writeFill(color, totalBytes);
+    if (_capturing) mirrorPixels(nullptr, color, (uint32_t)w * h);
+    return 0;
   }
   
-  digitalWrite(_dc, HIGH);
-  digitalWrite(_cs, LOW);
+  uint32_t fillBytes = totalBytes < lineBufferSize ? totalBytes : lineBufferSize;
+  uint8_t idx = colorBuffer(color, fillBytes);
   
-  uint32_t totalBytes = (uint32_t)w * h * 2;
+  setAddrWindow(x, y, x + w - 1, y + h - 1);
+  if (_capturing) mirrorPixels(nullptr, color, (uint32_t)w * h);
   
-  // Write full buffers with DMA
-  while (totalBytes >= DMA_BUFFER_SIZE) {
-    SPI.writeBytes(dmaBuffer, DMA_BUFFER_SIZE);
-    totalBytes -= DMA_BUFFER_SIZE;
+  // Repeat the buffer until the window is full
+  lineBuf[idx].fence = _bus.queuePattern(lineBuf[idx].data, fillBytes, totalBytes);
+  return lineBuf[idx].fence;
+}
+
+// Blocking fill from the stack, for tiny fills and when there are no line
+// buffers. Only as much of the chunk as will be sent is filled.
+template <class Bus>
+void ILI9486_Driver<Bus>::writeFill(uint16_t color, uint32_t totalBytes) {
+  uint8_t chunk[ILI9486_FALLBACK_FILL_BYTES];
+  uint32_t chunkBytes = totalBytes < sizeof(chunk) ? totalBytes : sizeof(chunk);
+  for (uint32_t i = 0; i < chunkBytes; i += 2) {
+    chunk[i] = color >> 8;
+    chunk[i + 1] = color & 0xFF;
   }
-  
-  // Write remaining bytes
-  if (totalBytes > 0) {
-    SPI.writeBytes(dmaBuffer, totalBytes);
+  _bus.writePattern(chunk, chunkBytes, totalBytes);
+}
+
+// Line buffer holding at least fillBytes of the color. A buffer that already
+// holds it is reused as is; otherwise the oldest one is filled (only as much
+// as will be sent).
+template <class Bus>
+uint8_t ILI9486_Driver<Bus>::colorBuffer(uint16_t color, uint32_t fillBytes) {
+  for (uint8_t i = 0; i < LINE_BUFFERS; i++) {
+    if (lineBuf[i].fillBytes >= fillBytes && lineBuf[i].fillColor == color) {
+      return i;
+    }
   }
   
-  digitalWrite(_cs, HIGH);
+  uint8_t idx = acquireLineBuffer();
+  uint8_t *buf = lineBuf[idx].data;
+  uint8_t hi = color >> 8;
+  uint8_t lo = color & 0xFF;
+  for (uint32_t i = 0; i < fillBytes; i += 2) {
+    buf[i] = hi;
+    buf[i + 1] = lo;
+  }
+  lineBuf[idx].fillColor = color;
+  lineBuf[idx].fillBytes = fillBytes;
+  return idx;
 }
 
-// DMA optimized fill (alias for fillRect with better performance)
-void ILI9486_Display::fillRectDMA(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
-  fillRect(x, y, w, h, color);
+// Stream a w x h block through the line buffers, clipped to the screen.
+// renderRow(dst, row, col, count) writes count big-endian RGB565 pixels of
+// block row "row", starting at block column "col". While one band is on the
+// wire the next one is being rendered into the other buffer.
+template <class Bus>
+template <class RowFn>
+void ILI9486_Driver<Bus>::pushRows(int16_t x, int16_t y, int16_t w, int16_t h, RowFn renderRow) {
+  if (streamIgnored()) return;
+  int16_t col = 0, row = 0;
+  if (x < 0) { col = -x; w += x; x = 0; }
+  if (y < 0) { row = -y; h += y; y = 0; }
+  if (x >= (int16_t)_width || y >= (int16_t)_height || w <= 0 || h <= 0) return;
+  if (x + w > (int16_t)_width) w = _width - x;
+  if (y + h > (int16_t)_height) h = _height - y;
+  
+  if (!lineBuf[0].data) return;
+  
+  uint16_t rowBytes = w * 2;
+  uint16_t bandRows = lineBufferSize / rowBytes;
+  
+  startWrite();
+  bool windowSet = false;
+  while (h > 0) {
+    uint16_t rows = h < (int16_t)bandRows ? h : bandRows;
+    uint8_t idx = acquireLineBuffer();
+    uint8_t *dst = lineBuf[idx].data;
+    lineBuf[idx].fillBytes = 0;
+    for (uint16_t r = 0; r < rows; r++) {
+      renderRow(dst, row + r, col, w);
+      dst += rowBytes;
+    }
+    
+    // First band is rendered before the window commands so it overlaps
+    // whatever was still being sent
+    if (!windowSet) {
+      setAddrWindow(x, y, x + w - 1, y + h - 1);
+      windowSet = true;
+    }
+    lineBuf[idx].fence = _bus.queueBytes(lineBuf[idx].data, (uint32_t)rows * rowBytes);
+    if (_capturing) mirrorBytes(lineBuf[idx].data, (uint32_t)rows * rowBytes);
+    row += rows;
+    h -= rows;
+  }
+  endWrite();
 }
 
-// Helper function for writing pixel arrays
-void ILI9486_Display::writePixels(uint16_t *colors, uint32_t len) {
-  digitalWrite(_dc, HIGH);
-  digitalWrite(_cs, LOW);
-  
-  // Convert to bytes and send
-  for (uint32_t i = 0; i < len; i++) {
-    SPI.transfer(colors[i] >> 8);
-    SPI.transfer(colors[i] & 0xFF);
+// DMA image push - rows that fall off the bottom are dropped, images that do
+// not fit horizontally are rejected (the rows would no longer be contiguous)
+template <class Bus>
+ILI9486_Fence ILI9486_Driver<Bus>::pushImageDMA(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *data) {
+  if (_drawMode == DRAW_RECORD) {
+    ListOp *op = listAdd(OP_IMAGE, y, y + h - 1);
+    if (op) {
+      op->v[0] = x; op->v[1] = y; op->v[2] = w; op->v[3] = h;
+      op->ptr = data;
+    }
+    return 0;
   }
+  if (x >= _width || y >= _height || x + w > _width) return 0;
+  if (y + h > _height) h = _height - y;
+  if (w == 0 || h == 0) return 0;
   
-  digitalWrite(_cs, HIGH);
+  startWrite();
+  setAddrWindow(x, y, x + w - 1, y + h - 1);
+  ILI9486_Fence fence = _bus.queueBytes((const uint8_t *)data, (uint32_t)w * h * 2);
+  if (_capturing) mirrorBytes((const uint8_t *)data, (uint32_t)w * h * 2);
+  endWrite();
+  return fence;
 }
 
-// Draw rectangle outline
-void ILI9486_Display::drawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
-  drawLine(x, y, x + w - 1, y, color);
-  drawLine(x + w - 1, y, x + w - 1, y + h - 1, color);
-  drawLine(x + w - 1, y + h - 1, x, y + h - 1, color);
-  drawLine(x, y + h - 1, x, y, color);
+// Start recording draw calls into the display list
+template <class Bus>
+bool ILI9486_Driver<Bus>::beginList(uint16_t maxOps) {
+  endDeferred();
+  if (maxOps > _listCap) {
+    ListOp *list = (ListOp *)realloc(_list, (size_t)maxOps * sizeof(ListOp));
+    if (!list) return false;
+    _list = list;
+    _listCap = maxOps;
+  }
+  _listLen = 0;
+  _listOverflow = false;
+  _drawMode = DRAW_RECORD;
+  return true;
 }
 
-// Draw single pixel
-void ILI9486_Display::drawPixel(uint16_t x, uint16_t y, uint16_t color) {
-  if (x >= _width || y >= _height) return;
-  setAddrWindow(x, y, x, y);
-  writeData16(color);
+template <class Bus>
+bool ILI9486_Driver<Bus>::endList() {
+  endDeferred();
+  _drawMode = DRAW_PANEL;
+  return !_listOverflow;
 }
 
-// Fast horizontal line
-void ILI9486_Display::drawFastHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color) {
-  if (x >= _width || y >= _height) return;
-  if (x + w > _width) w = _width - x;
-  fillRect(x, y, w, 1, color);
+template <class Bus>
+void ILI9486_Driver<Bus>::freeList() {
+  endDeferred();
+  _drawMode = DRAW_PANEL;
+  free(_list);
+  _list = nullptr;
+  _listCap = _listLen = 0;
+  freeStrips();
 }
 
-// Fast vertical line
-void ILI9486_Display::drawFastVLine(uint16_t x, uint16_t y, uint16_t h, uint16_t color) {
-  if (x >= _width || y >= _height) return;
-  if (y + h > _height) h = _height - y;
-  fillRect(x, y, 1, h, color);
+template <class Bus>
+void ILI9486_Driver<Bus>::freeStrips() {
+  for (uint8_t i = 0; i < _stripCount; i++) {
+    _bus.waitFence(_stripFence[i]);
+    ili9486_dma_free(_strip[i]);
+  }
+  _stripCount = 0;
+  _stripBytes = 0;
 }
 
-// Draw line
-void ILI9486_Display::drawLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color) {
-  int16_t steep = abs(y1 - y0) > abs(x1 - x0);
-  
-  if (steep) {
-    swap(x0, y0);
-    swap(x1, y1);
+template <class Bus>
+bool ILI9486_Driver<Bus>::setRenderThreads(uint8_t threads) {
+  return _workers.start(threads);
+}
+
+// Append an op, or flag the list as overflowed
+template <class Bus>
+typename ILI9486_Driver<Bus>::ListOp *ILI9486_Driver<Bus>::listAdd(uint8_t type, int16_t top, int16_t bottom) {
+  if (_listLen >= _listCap) {
+    if (!_deferred || _listCap == 0) {
+      _listOverflow = true;
+      return nullptr;
+    }
+    flushDeferred();
+  }
+  ListOp *op = &_list[_listLen++];
+  memset(op, 0, sizeof(ListOp));
+  op->type = type;
+  op->top = top;
+  op->bottom = bottom;
+  return op;
+}
+
+// Replay the display list band by band. While one strip is on the wire the
+// next bands are rendered into the others, by this thread and the render
+// workers; the strip of a band that has been sent goes to the next band
+// waiting for one.
+template <class Bus>
+bool ILI9486_Driver<Bus>::renderList(uint16_t bg, uint16_t bandRows) {
+  endList();
+  if (bandRows == 0) bandRows = 1;
+  if (bandRows > _height) bandRows = _height;
+  
+  // Strips, halving the band height until they fit
+  uint8_t strips = _workers.threads() + 2;
+  size_t bytes = (size_t)_width * bandRows * 2;
+  if (bytes > _stripBytes || strips > _stripCount) {
+    freeStrips();
+    while (true) {
+      while (_stripCount < strips && (_strip[_stripCount] = (uint8_t *)ili9486_dma_alloc(bytes))) {
+        _stripFence[_stripCount++] = 0;
+      }
+      if (_stripCount == strips) break;
+      freeStrips();
+      if (bandRows == 1) return false;
+      bandRows /= 2;
+      bytes = (size_t)_width * bandRows * 2;
+    }
+    _stripBytes = bytes;
   }
   
-  if (x0 > x1) {
-    swap(x0, x1);
-    swap(y0, y1);
+  // Strips may still be on the wire from the last render
+  for (uint8_t i = 0; i < _stripCount; i++) {
+    _bus.waitFence(_stripFence[i]);
   }
   
-  int16_t dx = x1 - x0;
-  int16_t dy = abs(y1 - y0);
-  int16_t err = dx / 2;
-  int16_t ystep = (y0 < y1) ? 1 : -1;
+  BandJob job = { _list, _listLen, _strip, _stripCount, _width, _height, bandRows, bg };
+  uint16_t bands = (_height + bandRows - 1) / bandRows;
+  _workers.run(renderBand, &job, bands, _stripCount, _stripCount);
   
-  for (; x0 <= x1; x0++) {
-    if (steep) {
-      drawPixel(y0, x0, color);
-    } else {
-      drawPixel(x0, y0, color);
-    }
-    err -= dy;
-    if (err < 0) {
-      y0 += ystep;
-      err += dx;
+  startWrite();
+  for (uint16_t b = 0; b < bands; b++) {
+    uint16_t y = b * bandRows;
+    uint16_t rows = _height - y < bandRows ? _height - y : bandRows;
+    uint8_t s = b % _stripCount;
+    _workers.wait(b);
+    
+    setAddrWindow(0, y, _width - 1, y + rows - 1);
+    _stripFence[s] = _bus.queueBytes(_strip[s], (uint32_t)_width * rows * 2);
+    if (_capturing) mirrorBytes(_strip[s], (uint32_t)_width * rows * 2);
+    
+    // The previous band has normally left by now; its strip is free
+    if (b > 0) {
+      _bus.waitFence(_stripFence[(b - 1) % _stripCount]);
+      _workers.release(b + _stripCount);
     }
   }
+  endWrite();
+  
+  _drawMode = DRAW_PANEL;
+  return true;
+}
+
+// Background, then every op that touches the band. Runs on any thread, so it
+// only reads the job and writes the band's strip.
+template <class Bus>
+void ILI9486_Driver<Bus>::renderBand(void *ctx, uint16_t band) {
+  const BandJob &job = *(const BandJob *)ctx;
+  uint16_t y = band * job.bandRows;
+  uint16_t rows = job.height - y < job.bandRows ? job.height - y : job.bandRows;
+  ILI9486_RamCanvas canvas;
+  canvas.setBuffer(job.strip[band % job.strips], job.width, job.height, y, rows);
+  canvas.fillRect(0, y, job.width, rows, job.bg);
+  for (uint16_t i = 0; i < job.listLen; i++) {
+    const ListOp &op = job.list[i];
+    if (op.bottom < (int16_t)y || op.top >= (int16_t)(y + rows)) continue;
+    replayOp(canvas, op);
+  }
 }
 
-// Draw circle
-void ILI9486_Display::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
-  int16_t f = 1 - r;
-  int16_t ddF_x = 1;
-  int16_t ddF_y = -2 * r;
-  int16_t x = 0;
-  int16_t y = r;
+template <class Bus>
+template <class Target>
+void ILI9486_Driver<Bus>::replayOp(Target &t, const ListOp &op) {
+  switch (op.type) {
+    case OP_FILL:
+      t.fillRect(op.v[0], op.v[1], op.v[2], op.v[3], op.color);
+      break;
+    case OP_PIXEL:
+      t.drawPixel(op.v[0], op.v[1], op.color);
+      break;
+    case OP_LINE:
+      t.drawLine(op.v[0], op.v[1], op.v[2], op.v[3], op.color);
+      break;
+    case OP_CIRCLE:
+      t.drawCircle(op.v[0], op.v[1], op.v[2], op.color);
+      break;
+    case OP_FILL_CIRCLE:
+      t.fillCircle(op.v[0], op.v[1], op.v[2], op.color);
+      break;
+    case OP_BITMAP:
+      t.drawBitmap(op.v[0], op.v[1], (const uint8_t *)op.ptr, op.v[2], op.v[3], op.color);
+      break;
+    case OP_BITMAP_BG:
+      t.drawBitmap(op.v[0], op.v[1], (const uint8_t *)op.ptr, op.v[2], op.v[3], op.color, op.bg);
+      break;
+    case OP_CHAR:
+      t.setFreeFont((const GFXfont *)op.ptr);
+      if (op.opaque) {
+        t.setTextColor(op.color, op.bg);
+      } else {
+        t.setTextColor(op.color);
+      }
+      t.drawChar(op.v[0], op.v[1], op.c, op.color, op.bg, op.size);
+      break;
+    case OP_IMAGE:
+      t.pushImage(op.v[0], op.v[1], op.v[2], op.v[3], (const uint16_t *)op.ptr);
+      break;
+  }
+}
+
+// Start a deferred frame. Returns false if a display list is being recorded
+// or the buffer cannot be allocated.
+template <class Bus>
+bool ILI9486_Driver<Bus>::beginDeferred(uint16_t maxOps) {
+  if (_deferred) return true;
+  if (_drawMode == DRAW_RECORD || !beginList(maxOps)) return false;
+  _deferred = true;
+  return true;
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::endDeferred() {
+  if (!_deferred) return;
+  flushDeferred();
+  _deferred = false;
+  _drawMode = DRAW_PANEL;
+}
+
+// Draw the deferred ops to the panel and empty the buffer; recording
+// goes on afterwards. Replaying text changes the font and colors, so the
+// caller's are put back.
+template <class Bus>
+void ILI9486_Driver<Bus>::flushDeferred() {
+  const GFXfont *font = this->gfxFont;
+  uint16_t fg = this->textcolor, bg = this->textbgcolor;
+  bool opaque = this->use_bg;
+  
+  optimizeList();
+  _drawMode = DRAW_PANEL;
+  startWrite();
+  for (uint16_t i = 0; i < _listLen; i++) {
+    replayOp(*this, _list[i]);
+  }
+  endWrite();
+  _drawMode = DRAW_RECORD;
+  _listLen = 0;
+  
+  this->gfxFont = font;
+  this->textcolor = fg;
+  this->textbgcolor = bg;
+  this->use_bg = opaque;
+}
+
+// Area an op can touch, clipped to the screen. False if it draws nothing.
+// Primitives taking unsigned coordinates wrap negative ones off the screen,
+// so a box taken over the signed coordinates still holds every pixel.
+template <class Bus>
+bool ILI9486_Driver<Bus>::opBox(const ListOp &op, OpBox &b) {
+  int32_t x0, y0, x1, y1;
+  b.solid = false;
+  switch (op.type) {
+    case OP_FILL:
+    case OP_IMAGE:
+      x0 = (uint16_t)op.v[0];
+      y0 = (uint16_t)op.v[1];
+      x1 = x0 + (uint16_t)op.v[2] - 1;
+      y1 = y0 + (uint16_t)op.v[3] - 1;
+      if (op.type == OP_IMAGE && x1 >= _width) return false;  // Rejected by pushImage()
+      b.solid = true;
+      break;
+    case OP_PIXEL:
+      x0 = x1 = (uint16_t)op.v[0];
+      y0 = y1 = (uint16_t)op.v[1];
+      break;
+    case OP_LINE:
+      x0 = op.v[0];
+      x1 = op.v[2];
+      y0 = op.v[1];
+      y1 = op.v[3];
+      if (x0 > x1) ili9486_swap(x0, x1);
+      if (y0 > y1) ili9486_swap(y0, y1);
+      break;
+    case OP_CIRCLE:
+    case OP_FILL_CIRCLE:
+      if (op.v[2] < 0) return false;  // Nothing drawn
+      x0 = op.v[0] - op.v[2];
+      x1 = op.v[0] + op.v[2];
+      y0 = op.v[1] - op.v[2];
+      y1 = op.v[1] + op.v[2];
+      break;
+    case OP_BITMAP:
+    case OP_BITMAP_BG:
+      x0 = op.v[0];
+      y0 = op.v[1];
+      x1 = x0 + op.v[2] - 1;
+      y1 = y0 + op.v[3] - 1;
+      b.solid = op.type == OP_BITMAP_BG;
+      break;
+    case OP_CHAR:
+      x0 = op.v[0];
+      if (op.ptr) {
+        const GFXfont *font = (const GFXfont *)op.ptr;
+        GFXglyph *glyph = &(((GFXglyph *)font->glyph)[op.c - font->first]);
+        x0 += (int8_t)pgm_read_byte(&glyph->xOffset) * op.size;
+        x1 = x0 + pgm_read_byte(&glyph->width) * op.size - 1;
+      } else {
+        x1 = x0 + 5 * op.size - 1;
+      }
+      y0 = op.top;
+      y1 = op.bottom;
+      b.solid = op.opaque;
+      break;
+    default:
+      return false;
+  }
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 >= _width) x1 = _width - 1;
+  if (y1 >= _height) y1 = _height - 1;
+  if (x0 > x1 || y0 > y1) return false;
+  b.x0 = x0;
+  b.y0 = y0;
+  b.x1 = x1;
+  b.y1 = y1;
+  return true;
+}
+
+// Deferred frame optimizer. The image drawn stays the same:
+//  1. Walking back from the last op, drop ops that a later solid op covers
+//     and trim fills along a side a later solid op covers. Whatever was
+//     drawn over that area in between is covered as well.
+//  2. Merge fills of one color that share an edge. The later fill may move
+//     back if nothing in between overlaps it, or the earlier one forward if
+//     nothing in between overlaps that.
+//  3. Reorder within a short lookahead: an op whose window has the columns
+//     and/or rows of the previous window is pulled forward past ops it does
+//     not overlap, so setAddrWindow() can skip CASET/RASET.
+template <class Bus>
+void ILI9486_Driver<Bus>::optimizeList() {
+  uint16_t n = _listLen;
+  OpBox *box = n ? (OpBox *)malloc((size_t)n * sizeof(OpBox)) : nullptr;
+  if (!box) return;
+  for (uint16_t i = 0; i < n; i++) {
+    box[i].live = opBox(_list[i], box[i]);
+  }
   
-  drawPixel(x0, y0 + r, color);
-  drawPixel(x0, y0 - r, color);
-  drawPixel(x0 + r, y0, color);
-  drawPixel(x0 - r, y0, color);
+  // 1. Occlusion
+  for (int32_t i = n - 1; i >= 0; i--) {
+    OpBox &a = box[i];
+    bool trimmed = a.live;
+    while (trimmed) {
+      trimmed = false;
+      for (uint16_t j = i + 1; j < n && a.live; j++) {
+        const OpBox &b = box[j];
+        if (!b.live || !b.solid) continue;
+        bool wide = b.x0 <= a.x0 && b.x1 >= a.x1;
+        bool tall = b.y0 <= a.y0 && b.y1 >= a.y1;
+        if (wide && tall) {
+          a.live = false;
+        } else if (_list[i].type == OP_FILL && wide && b.y0 <= a.y0 && b.y1 >= a.y0) {
+          a.y0 = b.y1 + 1;
+          trimmed = true;
+        } else if (_list[i].type == OP_FILL && wide && b.y0 <= a.y1 && b.y1 >= a.y1) {
+          a.y1 = b.y0 - 1;
+          trimmed = true;
+        } else if (_list[i].type == OP_FILL && tall && b.x0 <= a.x0 && b.x1 >= a.x0) {
+          a.x0 = b.x1 + 1;
+          trimmed = true;
+        } else if (_list[i].type == OP_FILL && tall && b.x0 <= a.x1 && b.x1 >= a.x1) {
+          a.x1 = b.x0 - 1;
+          trimmed = true;
+        }
+      }
+    }
+  }
   
-  while (x < y) {
-    if (f >= 0) {
-      y--;
-      ddF_y += 2;
-      f += ddF_y;
+  // 2. Merging
+  for (uint16_t i = 0; i < n; i++) {
+    if (!box[i].live || _list[i].type != OP_FILL) continue;
+    bool blocked = false;   // Something after i overlaps it: i cannot move forward
+    for (uint16_t j = i + 1; j < n; j++) {
+      OpBox &a = box[i], &b = box[j];
+      if (!b.live) continue;
+      if (_list[j].type == OP_FILL && _list[j].color == _list[i].color && boxAdjacent(a, b)) {
+        if (!blocked) {
+          b.x0 = a.x0 < b.x0 ? a.x0 : b.x0;
+          b.y0 = a.y0 < b.y0 ? a.y0 : b.y0;
+          b.x1 = a.x1 > b.x1 ? a.x1 : b.x1;
+          b.y1 = a.y1 > b.y1 ? a.y1 : b.y1;
+          a.live = false;
+          break;
+        }
+        bool clear = true;
+        for (uint16_t k = i + 1; k < j && clear; k++) {
+          clear = !box[k].live || !boxOverlap(box[k], b);
+        }
+        if (clear) {
+          a.x0 = a.x0 < b.x0 ? a.x0 : b.x0;
+          a.y0 = a.y0 < b.y0 ? a.y0 : b.y0;
+          a.x1 = a.x1 > b.x1 ? a.x1 : b.x1;
+          a.y1 = a.y1 > b.y1 ? a.y1 : b.y1;
+          b.live = false;
+          blocked = false;
+          j = i;            // i grew: look again from the start
+          continue;
+        }
+      }
+      if (boxOverlap(b, a)) blocked = true;
     }
-    x++;
-    ddF_x += 2;
-    f += ddF_x;
-    
-    drawPixel(x0 + x, y0 + y, color);
-    drawPixel(x0 - x, y0 + y, color);
-    drawPixel(x0 + x, y0 - y, color);
-    drawPixel(x0 - x, y0 - y, color);
-    drawPixel(x0 + y, y0 + x, color);
-    drawPixel(x0 - y, y0 + x, color);
-    drawPixel(x0 + y, y0 - x, color);
-    drawPixel(x0 - y, y0 - x, color);
-  }
-}
-
-// Fill circle - OPTIMIZED
-void ILI9486_Display::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
-  drawFastVLine(x0, y0 - r, 2 * r + 1, color);
-  
-  int16_t f = 1 - r;
-  int16_t ddF_x = 1;
-  int16_t ddF_y = -2 * r;
-  int16_t x = 0;
-  int16_t y = r;
-  
-  while (x < y) {
-    if (f >= 0) {
-      y--;
-      ddF_y += 2;
-      f += ddF_y;
-    }
-    x++;
-    ddF_x += 2;
-    f += ddF_x;
-    
-    drawFastVLine(x0 + x, y0 - y, 2 * y + 1, color);
-    drawFastVLine(x0 - x, y0 - y, 2 * y + 1, color);
-    drawFastVLine(x0 + y, y0 - x, 2 * x + 1, color);
-    drawFastVLine(x0 - y, y0 - x, 2 * x + 1, color);
   }
+  
+  // Drop dead ops and write back the fills' new areas
+  uint16_t len = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    if (!box[i].live) continue;
+    ListOp &op = _list[i];
+    if (op.type == OP_FILL) {
+      op.v[0] = box[i].x0;
+      op.v[1] = box[i].y0;
+      op.v[2] = box[i].x1 - box[i].x0 + 1;
+      op.v[3] = box[i].y1 - box[i].y0 + 1;
+      op.top = box[i].y0;
+      op.bottom = box[i].y1;
+    }
+    _list[len] = op;
+    box[len++] = box[i];
+  }
+  n = _listLen = len;
+  
+  // 3. Reordering. Only solid ops are known to send exactly one window.
+  bool lastValid = false;
+  OpBox last = { 0, 0, 0, 0, false, false };
+  for (uint16_t p = 0; p < n; p++) {
+    uint16_t best = p;
+    uint8_t bestScore = 0;
+    uint16_t end = n - p > REORDER_LOOKAHEAD ? p + REORDER_LOOKAHEAD : n;
+    for (uint16_t c = p; lastValid && c < end && bestScore < 2; c++) {
+      if (!box[c].solid) continue;
+      uint8_t score = (box[c].x0 == last.x0 && box[c].x1 == last.x1) + (box[c].y0 == last.y0 && box[c].y1 == last.y1);
+      if (score <= bestScore) continue;
+      bool clear = true;
+      for (uint16_t k = p; k < c && clear; k++) {
+        clear = !boxOverlap(box[k], box[c]);
+      }
+      if (clear) {
+        best = c;
+        bestScore = score;
+      }
+    }
+    if (best != p) {
+      ListOp op = _list[best];
+      OpBox b = box[best];
+      memmove(&_list[p + 1], &_list[p], (best - p) * sizeof(ListOp));
+      memmove(&box[p + 1], &box[p], (best - p) * sizeof(OpBox));
+      _list[p] = op;
+      box[p] = b;
+    }
+    lastValid = box[p].solid;
+    last = box[p];
+  }
+  free(box);
 }
 
-// Font functions
-void ILI9486_Display::setFreeFont(const GFXfont *f) {
-  gfxFont = (GFXfont *)f;
+// Allocate the canvas on first use
+template <class Bus>
+bool ILI9486_Driver<Bus>::beginCanvas() {
+  return allocCanvas(16);
 }
 
-void ILI9486_Display::setTextSize(uint8_t s) {
-  textsize = (s > 0) ? s : 1;
+template <class Bus>
+bool ILI9486_Driver<Bus>::beginMonoCanvas(uint16_t fg, uint16_t bg) {
+  if (!allocCanvas(1)) return false;
+  setMonoColors(fg, bg);
+  return true;
 }
 
-void ILI9486_Display::setTextDatum(uint8_t datum) {
-  textdatum = datum;
+template <class Bus>
+void ILI9486_Driver<Bus>::setMonoColors(uint16_t fg, uint16_t bg) {
+  if (fg == _monoColors[1] && bg == _monoColors[0]) return;
+  _monoColors[0] = bg;
+  _monoColors[1] = fg;
+  _canvas.paletteChanged();
+  if (_canvasBuf && _canvas.depth() == 1) dirtyAll();
 }
 
-void ILI9486_Display::setCursor(uint16_t x, uint16_t y) {
-  cursor_x = x;
-  cursor_y = y;
+// Canvas frame at the given depth, reallocated if the depth changed. A new
+// canvas starts cleared (black, or all background) and fully dirty, so the
+// first flush() syncs the panel.
+template <class Bus>
+bool ILI9486_Driver<Bus>::allocCanvas(uint8_t bpp) {
+  if (_canvasBuf && _canvas.depth() == bpp) return true;
+  bool tiles = _tileHash != nullptr;
+  if (_canvasBuf) freeCanvas();
+  size_t stride = ((uint32_t)_width * bpp + 7) / 8;
+  _canvasBuf = (uint8_t *)ili9486_frame_alloc(stride * _height);
+  if (!_canvasBuf) return false;
+  memset(_canvasBuf, 0, stride * _height);
+  _canvas.setDepth(bpp, _monoColors);
+  _canvas.setBuffer(_canvasBuf, _width, _height);
+  if (tiles) setTileFlush(true);
+  dirtyAll();
+  return true;
 }
 
-void ILI9486_Display::setTextColor(uint16_t color) {
-  textcolor = color;
-  use_bg = false;
+template <class Bus>
+void ILI9486_Driver<Bus>::dirtyAll() {
+  _dirty.clear();
+  _dirty.add(0, 0, _width, _height);
+  _tilesValid = false;
 }
 
-void ILI9486_Display::setTextColor(uint16_t fg, uint16_t bg) {
-  textcolor = fg;
-  textbgcolor = bg;
-  use_bg = true;
+template <class Bus>
+void ILI9486_Driver<Bus>::freeCanvas() {
+  ili9486_dma_free(_canvasBuf);
+  _canvasBuf = nullptr;
+  _canvas.setBuffer(nullptr, 0, 0);
+  _dirty.clear();
+  setTileFlush(false);
 }
 
-// Draw character using GFX font - HIGHLY OPTIMIZED with horizontal runs and smooth edges
-void ILI9486_Display::drawGFXChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
-  if (!gfxFont) return;
-  
-  c -= gfxFont->first;
-  if (c > (gfxFont->last - gfxFont->first)) return;
-  
-  GFXglyph *glyph = &(((GFXglyph *)gfxFont->glyph)[c]);
-  uint8_t *bitmap = gfxFont->bitmap;
-  
-  uint16_t bo = pgm_read_word(&glyph->bitmapOffset);
-  uint8_t w = pgm_read_byte(&glyph->width);
-  uint8_t h = pgm_read_byte(&glyph->height);
-  int8_t xo = pgm_read_byte(&glyph->xOffset);
-  int8_t yo = pgm_read_byte(&glyph->yOffset);
+template <class Bus>
+bool ILI9486_Driver<Bus>::setTileFlush(bool enable) {
+  if (!enable) {
+    free(_tileHash);
+    _tileHash = nullptr;
+    return true;
+  }
+  if (!_tileHash) {
+    // Same tile count in every rotation
+    uint16_t cols = (_width + ILI9486_TILE_SIZE - 1) / ILI9486_TILE_SIZE;
+    uint16_t rows = (_height + ILI9486_TILE_SIZE - 1) / ILI9486_TILE_SIZE;
+    _tileHash = (uint32_t *)malloc((size_t)cols * rows * sizeof(uint32_t));
+    if (!_tileHash) return false;
+    _tilesValid = false;
+  }
+  return true;
+}
+
+// Send the dirty areas of the canvas, each as one window streamed through
+// the line buffers
+template <class Bus>
+void ILI9486_Driver<Bus>::flush() {
+  if (!_canvasBuf || _dirty.count() == 0) return;
+  if (_tileHash) {
+    flushTiles();
+    return;
+  }
   
-  if (size == 1) {
-    // Clear background if needed
-    if (use_bg) {
-      fillRect(x + xo, y + yo, w, h, bg);
+  uint8_t mode = _drawMode;
+  _drawMode = DRAW_PANEL;
+  startWrite();
+  for (uint8_t i = 0; i < _dirty.count(); i++) {
+    const ILI9486_DirtyRect &d = _dirty[i];
+    pushRows(d.x0, d.y0, d.x1 - d.x0 + 1, d.y1 - d.y0 + 1,
+      [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+        _canvas.readRow(dst, d.y0 + row, d.x0 + col, count);
+      });
+  }
+  endWrite();
+  _dirty.clear();
+  _drawMode = mode;
+}
+
+// Hash of a canvas area (FNV-1a, 32 bits at a time). On an indexed frame
+// the bytes holding the area are hashed.
+template <class Bus>
+uint32_t ILI9486_Driver<Bus>::tileHash(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  uint32_t hash = 2166136261u;
+  uint8_t bpp = _canvas.depth();
+  uint32_t first = (uint32_t)x * bpp / 8;
+  uint16_t n0 = ((uint32_t)(x + w) * bpp + 7) / 8 - first;
+  for (uint16_t r = 0; r < h; r++) {
+    const uint8_t *src = _canvasBuf + (uint32_t)(y + r) * _canvas.stride() + first;
+    uint16_t n = n0;
+    for (; n >= 4; n -= 4, src += 4) {
+      uint32_t word;
+      memcpy(&word, src, 4);
+      hash = (hash ^ word) * 16777619u;
+    }
+    for (; n > 0; n--) {
+      hash = (hash ^ *src++) * 16777619u;
     }
+  }
+  return hash;
+}
+
+// Tile-hash flush: only tiles touched by a dirty area can have changed, so
+// only those are hashed; tiles whose hash moved are sent, one window per run
+// of neighbouring tiles
+template <class Bus>
+void ILI9486_Driver<Bus>::flushTiles() {
+  const uint16_t T = ILI9486_TILE_SIZE;
+  uint16_t cols = (_width + T - 1) / T;
+  uint16_t rows = (_height + T - 1) / T;
+  assert(cols <= MAX_TILE_COLS);
+  if (cols != _tileCols) {
+    _tileCols = cols;     // Rotated: old hashes describe a different grid
+    _tilesValid = false;
+  }
+  
+  uint8_t mode = _drawMode;
+  _drawMode = DRAW_PANEL;
+  startWrite();
+  for (uint16_t ty = 0; ty < rows; ty++) {
+    uint16_t y = ty * T;
+    uint16_t th = _height - y < T ? _height - y : T;
     
-    // Draw using horizontal runs for speed
-    uint8_t bits = 0, bit = 0;
-    uint16_t bitOffset = bo;
+    // Columns of this tile row covered by a dirty area
+    bool touched[MAX_TILE_COLS];
+    memset(touched, !_tilesValid, sizeof(touched));
+    for (uint8_t i = 0; i < _dirty.count(); i++) {
+      const ILI9486_DirtyRect &d = _dirty[i];
+      if (d.y1 < y || d.y0 >= y + th) continue;
+      for (uint16_t tx = d.x0 / T; tx <= d.x1 / T && tx < cols; tx++) {
+        touched[tx] = true;
+      }
+    }
     
-    for (uint8_t yy = 0; yy < h; yy++) {
-      int16_t runStart = -1;
-      
-      for (uint8_t xx = 0; xx < w; xx++) {
-        if (!(bit++ & 7)) {
-          bits = pgm_read_byte(&bitmap[bitOffset++]);
-        }
-        
-        if (bits & 0x80) {
-          // Pixel is ON
-          if (runStart < 0) {
-            runStart = xx; // Start new run
-          }
-        } else {
-          // Pixel is OFF
-          if (runStart >= 0) {
-            // End of run - draw it with fillRect for perfect edges
-            fillRect(x + xo + runStart, y + yo + yy, xx - runStart, 1, color);
-            runStart = -1;
-          }
-        }
-        bits <<= 1;
+    int16_t runStart = -1;
+    for (uint16_t tx = 0; tx <= cols; tx++) {
+      bool changed = false;
+      if (tx < cols && touched[tx]) {
+        uint16_t x = tx * T;
+        uint32_t hash = tileHash(x, y, _width - x < T ? _width - x : T, th);
+        uint32_t &last = _tileHash[(uint32_t)ty * cols + tx];
+        changed = !_tilesValid || hash != last;
+        last = hash;
       }
-      
-      // Draw any remaining run at end of row
-      if (runStart >= 0) {
-        fillRect(x + xo + runStart, y + yo + yy, w - runStart, 1, color);
+      if (changed) {
+        if (runStart < 0) runStart = tx;
+      } else if (runStart >= 0) {
+        uint16_t x0 = runStart * T;
+        uint16_t x1 = tx * T < _width ? tx * T : _width;
+        pushRows(x0, y, x1 - x0, th,
+          [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+            _canvas.readRow(dst, y + row, x0 + col, count);
+          });
+        runStart = -1;
       }
     }
-  } else {
-    // Scaled characters - use original method
-    uint8_t bits = 0, bit = 0;
-    uint16_t bitOffset = bo;
-    
-    for (uint8_t yy = 0; yy < h; yy++) {
-      for (uint8_t xx = 0; xx < w; xx++) {
-        if (!(bit++ & 7)) {
-          bits = pgm_read_byte(&bitmap[bitOffset++]);
-        }
-        if (bits & 0x80) {
-          fillRect(x + (xo + xx) * size, y + (yo + yy) * size, size, size, color);
-        } else if (use_bg) {
-          fillRect(x + (xo + xx) * size, y + (yo + yy) * size, size, size, bg);
+  }
+  endWrite();
+  _tilesValid = true;
+  _dirty.clear();
+  _drawMode = mode;
+}
+
+template <class Bus>
+bool ILI9486_Driver<Bus>::beginMirror(bool compact) {
+  endMirror();
+  _mirror = (MirrorRow *)malloc(PANEL_HEIGHT * sizeof(MirrorRow));
+  if (!_mirror) return false;
+  for (uint16_t i = 0; i < PANEL_HEIGHT; i++) {
+    _mirror[i].px = nullptr;
+  }
+  _mirCompact = compact;
+  if (!compact) {
+    _mirBlock = (uint8_t *)ili9486_frame_alloc((size_t)PANEL_WIDTH * PANEL_HEIGHT * 2);
+    if (!_mirBlock) {
+      endMirror();
+      return false;
+    }
+  }
+  mirrorReset();
+  mirrorWindow(0, 0, _width - 1, _height - 1);
+  updateCapturing();
+  return true;
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::endMirror() {
+  if (!_mirror) return;
+  if (_mirCompact) {
+    for (uint16_t i = 0; i < PANEL_HEIGHT; i++) {
+      free(_mirror[i].px);
+    }
+  }
+  ili9486_dma_free(_mirBlock);
+  _mirBlock = nullptr;
+  free(_mirror);
+  _mirror = nullptr;
+  updateCapturing();
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::updateCapturing() {
+  _capturing = _mirror != nullptr;
+  for (uint8_t i = 0; i < ILI9486_SAVE_UNDERS; i++) {
+    if (_saveUnder[i].px && _saveUnder[i].capturing) _capturing = true;
+  }
+}
+
+// Black mirror
+template <class Bus>
+void ILI9486_Driver<Bus>::mirrorReset() {
+  if (_mirCompact) {
+    for (uint16_t i = 0; i < PANEL_HEIGHT; i++) {
+      free(_mirror[i].px);
+      _mirror[i].px = nullptr;
+      _mirror[i].color = TFT_BLACK;
+    }
+    return;
+  }
+  memset(_mirBlock, 0, (size_t)PANEL_WIDTH * PANEL_HEIGHT * 2);
+  for (uint16_t i = 0; i < PANEL_HEIGHT; i++) {
+    _mirror[i].px = _mirBlock + (uint32_t)i * PANEL_WIDTH * 2;
+  }
+}
+
+// A memory write started: pixels go to the window from its top left corner
+template <class Bus>
+void ILI9486_Driver<Bus>::mirrorWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+  _mirX0 = _mirX = x0;
+  _mirY0 = _mirY = y0;
+  _mirX1 = x1;
+  _mirY1 = y1;
+  _mirOdd = false;
+}
+
+// Pixel data in panel byte order. A pixel may be split between two calls.
+template <class Bus>
+void ILI9486_Driver<Bus>::mirrorBytes(const uint8_t *data, uint32_t len) {
+  if (len == 0) return;
+  if (_mirOdd) {
+    uint8_t pixel[2] = { _mirByte, data[0] };
+    mirrorPixels(pixel, 0, 1);
+    data++;
+    len--;
+    _mirOdd = false;
+  }
+  mirrorPixels(data, 0, len / 2);
+  if (len & 1) {
+    _mirByte = data[len - 1];
+    _mirOdd = true;
+  }
+}
+
+// Advance the write pointer over count pixels, taken from src (panel byte
+// order) or all of one color when src is nullptr, a row span at a time, and
+// copy them into the mirror and every capturing save-under region. Whole
+// rows of one color go into the mirror as one block.
+template <class Bus>
+void ILI9486_Driver<Bus>::mirrorPixels(const uint8_t *src, uint16_t color, uint32_t count) {
+  uint16_t filled = 0;      // Rows of the window already in the mirror
+  while (count > 0) {
+    uint32_t n = _mirX1 - _mirX + 1;
+    if (n > count) n = count;
+    if (_mirY < _height && _mirX < _width) {
+      uint16_t visible = _mirX + n > _width ? _width - _mirX : n;
+      if (_mirror && src) {
+        mirrorSpan(_mirX, _mirY, visible, src);
+      } else if (_mirror && filled) {
+        filled--;
+      } else if (_mirror) {
+        uint32_t rows = _mirX == _mirX0 ? count / n : 1;
+        uint16_t last = _mirY1 < _height ? _mirY1 : _height - 1;
+        if (rows > (uint32_t)(last - _mirY + 1)) rows = last - _mirY + 1;
+        mirrorFill(_mirX, _mirY, visible, rows, color);
+        filled = rows - 1;
+      }
+      for (uint8_t i = 0; i < ILI9486_SAVE_UNDERS; i++) {
+        SaveUnder &su = _saveUnder[i];
+        if (!su.px || !su.capturing || _mirY < su.y || _mirY >= su.y + su.h) continue;
+        uint16_t x0 = _mirX > su.x ? _mirX : su.x;
+        uint16_t x1 = _mirX + visible < su.x + su.w ? _mirX + visible : su.x + su.w;
+        if (x0 >= x1) continue;
+        uint8_t *dst = su.px + ((uint32_t)(_mirY - su.y) * su.w + x0 - su.x) * 2;
+        if (src) {
+          memcpy(dst, src + (x0 - _mirX) * 2, (x1 - x0) * 2);
+        } else {
+          for (uint16_t x = x0; x < x1; x++) {
+            *dst++ = color >> 8;
+            *dst++ = color & 0xFF;
+          }
         }
-        bits <<= 1;
       }
     }
+    if (src) src += n * 2;
+    count -= n;
+    _mirX += n;
+    if (_mirX > _mirX1) {
+      _mirX = _mirX0;
+      if (++_mirY > _mirY1) _mirY = _mirY0;
+    }
   }
 }
 
-// Draw character (simple 5x7 font or GFX font)
-void ILI9486_Display::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
-  if (gfxFont) {
-    drawGFXChar(x, y, c, color, bg, size);
+// Write n pixels of row y (current rotation) from src. Other rotations
+// store them one by one, down or up a column or right to left.
+template <class Bus>
+void ILI9486_Driver<Bus>::mirrorSpan(uint16_t x, uint16_t y, uint16_t n, const uint8_t *src) {
+  if (_rotation == 0) {
+    mirrorRow(y, x, n, src, 0);
     return;
   }
-  
-  // Built-in 5x7 font
-  if (c < 32 || c > 122) c = 32; // Limit to printable ASCII
-  
-  const uint8_t *glyph = &font5x7[(c - 32) * 5];
-  
-  for (int8_t i = 0; i < 5; i++) {
-    uint8_t line = pgm_read_byte(&glyph[i]);
-    for (int8_t j = 0; j < 8; j++) {
-      if (line & 0x1) {
-        if (size == 1) drawPixel(x + i, y + j, color);
-        else fillRect(x + i * size, y + j * size, size, size, color);
-      } else if (use_bg) {
-        if (size == 1) drawPixel(x + i, y + j, bg);
-        else fillRect(x + i * size, y + j * size, size, size, bg);
-      }
-      line >>= 1;
+  for (uint16_t i = 0; i < n; i++) {
+    uint16_t xx = x + i;
+    switch (_rotation) {
+      case 1:
+        mirrorRow(xx, PANEL_WIDTH - 1 - y, 1, src + i * 2, 0);
+        break;
+      case 2:
+        mirrorRow(PANEL_HEIGHT - 1 - y, PANEL_WIDTH - 1 - xx, 1, src + i * 2, 0);
+        break;
+      case 3:
+        mirrorRow(PANEL_HEIGHT - 1 - xx, y, 1, src + i * 2, 0);
+        break;
     }
   }
 }
 
-void ILI9486_Display::print(const char *str) {
-  if (gfxFont) {
-    // GFX font
-    while (*str) {
-      char c = *str++;
-      if (c == '\n') {
-        cursor_x = 0;
-        cursor_y += gfxFont->yAdvance * textsize;
-        continue;
-      }
-      if (c < gfxFont->first || c > gfxFont->last) continue;
-      
-      uint8_t glyph_index = c - gfxFont->first;
-      GFXglyph *glyph = &(((GFXglyph *)gfxFont->glyph)[glyph_index]);
-      drawGFXChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
-      cursor_x += pgm_read_byte(&glyph->xAdvance) * textsize;
+// Fill a block (current rotation) with one color, a controller row at a time
+template <class Bus>
+void ILI9486_Driver<Bus>::mirrorFill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+  uint16_t nx = x, ny = y, nw = w, nh = h;
+  switch (_rotation) {
+    case 1:
+      nx = PANEL_WIDTH - y - h;
+      ny = x;
+      nw = h;
+      nh = w;
+      break;
+    case 2:
+      nx = PANEL_WIDTH - x - w;
+      ny = PANEL_HEIGHT - y - h;
+      break;
+    case 3:
+      nx = y;
+      ny = PANEL_HEIGHT - x - w;
+      nw = h;
+      nh = w;
+      break;
+  }
+  for (uint16_t r = 0; r < nh; r++) {
+    mirrorRow(ny + r, nx, nw, nullptr, color);
+  }
+}
+
+// Pixel at x, y of the current rotation
+template <class Bus>
+uint16_t ILI9486_Driver<Bus>::mirrorRead(uint16_t x, uint16_t y) {
+  uint16_t nx = x, ny = y;
+  switch (_rotation) {
+    case 1:
+      nx = PANEL_WIDTH - 1 - y;
+      ny = x;
+      break;
+    case 2:
+      nx = PANEL_WIDTH - 1 - x;
+      ny = PANEL_HEIGHT - 1 - y;
+      break;
+    case 3:
+      nx = y;
+      ny = PANEL_HEIGHT - 1 - x;
+      break;
+  }
+  const MirrorRow &row = _mirror[ny];
+  return row.px ? (row.px[2 * nx] << 8) | row.px[2 * nx + 1] : row.color;
+}
+
+// Write n pixels of controller row y. A compact row stays a single color until
+// something else is written into it, and becomes one again when it is
+// filled edge to edge. If a row cannot be allocated it keeps its color.
+template <class Bus>
+void ILI9486_Driver<Bus>::mirrorRow(uint16_t y, uint16_t x, uint16_t n, const uint8_t *src, uint16_t color) {
+  MirrorRow &row = _mirror[y];
+  if (_mirCompact && !src && x == 0 && n == PANEL_WIDTH) {
+    free(row.px);
+    row.px = nullptr;
+    row.color = color;
+    return;
+  }
+  if (!row.px) {
+    if (!src && color == row.color) return;
+    row.px = (uint8_t *)malloc(PANEL_WIDTH * 2);
+    if (!row.px) return;
+    for (uint16_t i = 0; i < PANEL_WIDTH; i++) {
+      row.px[2 * i] = row.color >> 8;
+      row.px[2 * i + 1] = row.color & 0xFF;
     }
+  }
+  uint8_t *dst = row.px + x * 2;
+  if (src) {
+    memcpy(dst, src, n * 2);
   } else {
-    // Built-in font
-    while (*str) {
-      if (*str == '\n') {
-        cursor_x = 0;
-        cursor_y += 8 * textsize;
-        str++;
-        continue;
+    for (uint16_t i = 0; i < n; i++) {
+      *dst++ = color >> 8;
+      *dst++ = color & 0xFF;
+    }
+  }
+}
+
+template <class Bus>
+int8_t ILI9486_Driver<Bus>::addSaveUnder(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  if (x >= _width || y >= _height || w == 0 || h == 0) return -1;
+  if (x + w > _width) w = _width - x;
+  if (y + h > _height) h = _height - y;
+  for (int8_t id = 0; id < ILI9486_SAVE_UNDERS; id++) {
+    SaveUnder &su = _saveUnder[id];
+    if (su.px) continue;
+    su.px = (uint8_t *)ili9486_frame_alloc((size_t)w * h * 2);
+    if (!su.px) return -1;
+    su.x = x;
+    su.y = y;
+    su.w = w;
+    su.h = h;
+    su.capturing = true;
+    
+    // What is on the panel now, if the mirror knows it
+    memset(su.px, 0, (size_t)w * h * 2);
+    if (_mirror) {
+      uint8_t *dst = su.px;
+      for (uint16_t r = 0; r < h; r++) {
+        for (uint16_t c = 0; c < w; c++) {
+          uint16_t color = mirrorRead(x + c, y + r);
+          *dst++ = color >> 8;
+          *dst++ = color & 0xFF;
+        }
       }
-      drawChar(cursor_x, cursor_y, *str++, textcolor, textbgcolor, textsize);
-      cursor_x += 6 * textsize;
     }
+    updateCapturing();
+    return id;
   }
+  return -1;
 }
 
-void ILI9486_Display::print(int num) {
-  char buf[12];
-  itoa(num, buf, 10);
-  print(buf);
+template <class Bus>
+void ILI9486_Driver<Bus>::suspendSaveUnder(int8_t id) {
+  if (id < 0 || id >= ILI9486_SAVE_UNDERS) return;
+  _saveUnder[id].capturing = false;
+  updateCapturing();
 }
 
-void ILI9486_Display::print(unsigned long num) {
-  char buf[12];
-  ultoa(num, buf, 10);
-  print(buf);
+// One window streamed through the line buffers. The pushed pixels also pass
+// the capture hook, so the mirror and overlapping regions stay in sync.
+template <class Bus>
+void ILI9486_Driver<Bus>::restoreSaveUnder(int8_t id) {
+  if (id < 0 || id >= ILI9486_SAVE_UNDERS || !_saveUnder[id].px) return;
+  SaveUnder &su = _saveUnder[id];
+  su.capturing = true;
+  updateCapturing();
+  uint8_t mode = _drawMode;
+  _drawMode = DRAW_PANEL;
+  pushRows(su.x, su.y, su.w, su.h, [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+    memcpy(dst, su.px + ((uint32_t)row * su.w + col) * 2, count * 2);
+  });
+  _drawMode = mode;
 }
 
-void ILI9486_Display::print(float num, int decimals) {
-  char buf[20];
-  dtostrf(num, 0, decimals, buf);
-  print(buf);
+template <class Bus>
+void ILI9486_Driver<Bus>::removeSaveUnder(int8_t id) {
+  if (id < 0 || id >= ILI9486_SAVE_UNDERS || !_saveUnder[id].px) return;
+  ili9486_dma_free(_saveUnder[id].px);
+  _saveUnder[id].px = nullptr;
+  updateCapturing();
 }
 
-void ILI9486_Display::println(const char *str) {
-  print(str);
-  cursor_x = 0;
-  if (gfxFont) {
-    cursor_y += gfxFont->yAdvance * textsize;
-  } else {
-    cursor_y += 8 * textsize;
-  }
+template <class Bus>
+uint16_t ILI9486_Driver<Bus>::readPixel(uint16_t x, uint16_t y) {
+  uint16_t color = 0;
+  readRect(x, y, 1, 1, &color);
+  return color;
 }
 
-void ILI9486_Display::println(int num) {
-  print(num);
-  cursor_x = 0;
-  if (gfxFont) {
-    cursor_y += gfxFont->yAdvance * textsize;
-  } else {
-    cursor_y += 8 * textsize;
-  }
-}
-
-// Draw string at specific position, restore cursor, return width
-int16_t ILI9486_Display::drawString(const String &string, int32_t x, int32_t y, uint8_t font) {
-  // Save current state
-  uint16_t old_x = cursor_x;
-  uint16_t old_y = cursor_y;
-  uint8_t old_size = textsize;
-  const GFXfont *old_font = gfxFont;
-  
-  // Font selection logic
-  if (font == 0) {
-    // Use current font from setFreeFont() (could be nullptr for built-in 5x7)
-    // gfxFont already set, no change needed
-    textsize = old_size;  // Keep current textsize
-  } else if (font == 1) {
-    // Explicitly select built-in 5x7 font
-    gfxFont = nullptr;
-    textsize = old_size;  // Allow scaling
-  } else if (font < 6) {
-    // Select from font array (indices 2-5)
-    if (fontArray[font] != nullptr) {
-      gfxFont = fontArray[font];
-      textsize = old_size;  // Allow scaling
-    } else {
-      // Font slot empty, fall back to built-in 5x7
-      gfxFont = nullptr;
-      textsize = old_size;
+// Pixels outside the screen (or with nothing to read from) read as 0
+template <class Bus>
+void ILI9486_Driver<Bus>::readRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *data) {
+  for (uint16_t r = 0; r < h; r++) {
+    for (uint16_t c = 0; c < w; c++) {
+      uint16_t xx = x + c, yy = y + r;
+      uint16_t color = 0;
+      if (_mirror && xx < _width && yy < _height) color = mirrorRead(xx, yy);
+      *data++ = color;
     }
-  } else {
-    // Out of bounds, fall back to built-in 5x7
-    gfxFont = nullptr;
-    textsize = old_size;
   }
+}
+
+// Replay a blob recorded with ILI9486_BlobBus. Data records are copied
+// through the line buffers so the copy of one chunk overlaps the transfer of
+// the previous one, and fill records are sent from a color buffer.
+template <class Bus>
+bool ILI9486_Driver<Bus>::pushBlob(const uint8_t *blob) {
+  if (streamIgnored()) return false;
+  if (pgm_read_byte(blob) != 'I' || pgm_read_byte(blob + 1) != 'L' ||
+      pgm_read_byte(blob + 2) != 'B' || pgm_read_byte(blob + 3) != ILI9486_BLOB_VERSION) {
+    return false;
+  }
+  const uint8_t *p = blob + 4;
+  bool ok = true;
+  
+  // Follow the blob's address window so the mirror sees its pixels
+  uint8_t cmd = 0, param[4], params = 0;
+  uint16_t win[4] = { _mirX0, _mirX1, _mirY0, _mirY1 };
+  auto mirrorData = [&](const uint8_t *data, uint32_t n) {
+    if (!_capturing) return;
+    if (cmd == 0x2C) {
+      mirrorBytes(data, n);
+    } else if (cmd == 0x2A || cmd == 0x2B) {
+      for (uint32_t i = 0; i < n && params < 4; i++) param[params++] = data[i];
+      if (params == 4) {
+        uint16_t *bounds = &win[cmd == 0x2A ? 0 : 2];
+        bounds[0] = (param[0] << 8) | param[1];
+        bounds[1] = (param[2] << 8) | param[3];
+      }
+    }
+  };
   
-  // Calculate width and height before drawing
-  int16_t width = 0;
-  int16_t height = 0;
-  int16_t ascent = 0;
-  
-  if (gfxFont) {
-    // GFX font - calculate bounds
-    int16_t minY = 127, maxY = -128;  // Track min/max Y offsets
+  startWrite();
+  for (;;) {
+    uint8_t op = pgm_read_byte(p++);
+    if (op == ILI9486_BLOB_END) break;
     
-    for (unsigned int i = 0; i < string.length(); i++) {
-      char c = string[i];
-      if (c >= gfxFont->first && c <= gfxFont->last) {
-        uint8_t glyph_index = c - gfxFont->first;
-        GFXglyph *glyph = &(((GFXglyph *)gfxFont->glyph)[glyph_index]);
-        width += pgm_read_byte(&glyph->xAdvance) * textsize;
-        
-        // Track Y bounds for height calculation
-        int8_t yo = pgm_read_byte(&glyph->yOffset);
-        uint8_t h = pgm_read_byte(&glyph->height);
-        if (yo < minY) minY = yo;
-        if (yo + h > maxY) maxY = yo + h;
+    if (op == ILI9486_BLOB_CMD) {
+      cmd = pgm_read_byte(p++);
+      params = 0;
+      _bus.writeCommand(cmd);
+      if (cmd == 0x2C && _capturing) mirrorWindow(win[0], win[2], win[1], win[3]);
+    } else if (op == ILI9486_BLOB_DATA) {
+      uint32_t len = pgm_read_byte(p) | (pgm_read_byte(p + 1) << 8);
+      p += 2;
+      while (len > 0) {
+        uint8_t small[ILI9486_SMALL_FILL_BYTES];
+        if (len <= sizeof(small) || !lineBuf[0].data) {
+          uint32_t n = len < sizeof(small) ? len : sizeof(small);
+          memcpy_P(small, p, n);
+          _bus.writeBytes(small, n);
+          mirrorData(small, n);
+          p += n;
+          len -= n;
+        } else {
+          uint32_t n = len < lineBufferSize ? len : lineBufferSize;
+          uint8_t idx = acquireLineBuffer();
+          memcpy_P(lineBuf[idx].data, p, n);
+          lineBuf[idx].fillBytes = 0;
+          lineBuf[idx].fence = _bus.queueBytes(lineBuf[idx].data, n);
+          mirrorData(lineBuf[idx].data, n);
+          p += n;
+          len -= n;
+        }
+      }
+    } else if (op == ILI9486_BLOB_FILL) {
+      uint32_t count = 0;
+      for (uint8_t i = 0; i < 4; i++) {
+        count |= (uint32_t)pgm_read_byte(p++) << (8 * i);
       }
+      uint16_t color = pgm_read_byte(p) << 8 | pgm_read_byte(p + 1);
+      p += 2;
+      pushBlock(color, count);
+    } else {
+      ok = false;  // Corrupt blob, stop here
+      break;
     }
-    
-    ascent = -minY * textsize;   // Distance above baseline (minY is negative)
-    height = (maxY - minY) * textsize;
+  }
+  
+  // The blob set its own window and orientation; put the controller back in
+  // the state this driver expects
+  invalidateShadow();
+  setRotation(_rotation);
+  endWrite();
+  return ok;
+}
+
+// Direct streaming cannot be recorded: a display list ignores it, a deferred
+// frame is drawn first so the stream lands on top of it
+template <class Bus>
+bool ILI9486_Driver<Bus>::streamIgnored() {
+  if (_drawMode != DRAW_RECORD) return false;
+  endDeferred();
+  return _drawMode == DRAW_RECORD;
+}
+
+// Set the address window for pushBlock()/pushPixels() (inclusive corners)
+template <class Bus>
+void ILI9486_Driver<Bus>::setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+  if (streamIgnored()) return;
+  if (x0 > x1) ili9486_swap(x0, x1);
+  if (y0 > y1) ili9486_swap(y0, y1);
+  setAddrWindow(x0, y0, x1, y1);
+}
+
+// Send one color len times, repeating a line buffer that holds it
+template <class Bus>
+void ILI9486_Driver<Bus>::pushBlock(uint16_t color, uint32_t len) {
+  uint32_t totalBytes = len * 2;
+  if (totalBytes == 0 || streamIgnored()) return;
+  if (_capturing) mirrorPixels(nullptr, color, len);
+  
+  startWrite();
+  if (totalBytes <= ILI9486_SMALL_FILL_BYTES || !lineBuf[0].data) {
+    writeFill(color, totalBytes);
   } else {
-    // Built-in font - 6 pixels per char (5 + 1 spacing), 8 pixels tall
-    width = string.length() * 6 * textsize;
-    height = 8 * textsize;
-    ascent = height;  // All above baseline for built-in font
-  }
-  
-  // Apply datum positioning
-  int16_t adjusted_x = x;
-  int16_t adjusted_y = y;
-  
-  // Horizontal adjustment based on datum
-  uint8_t h_datum = textdatum % 3;  // 0=Left, 1=Center, 2=Right
-  if (h_datum == 1) {
-    adjusted_x -= width / 2;  // Center
-  } else if (h_datum == 2) {
-    adjusted_x -= width;  // Right
-  }
-  
-  // Vertical adjustment based on datum
-  uint8_t v_datum = textdatum / 3;  // 0=Top, 1=Middle, 2=Bottom
-  if (v_datum == 0) {
-    // Top datum - adjust so y is at top of text
-    if (gfxFont) {
-      adjusted_y += ascent;  // Move down by ascent
-    }
-    // Built-in font: no adjustment needed (draws from top)
-  } else if (v_datum == 1) {
-    // Middle datum - adjust so y is at vertical center
-    if (gfxFont) {
-      adjusted_y += ascent - (height / 2);
-    } else {
-      adjusted_y += height / 2;
-    }
-  }
-  // Bottom/Baseline datum (v_datum == 2): no adjustment (default GFX behavior)
-  
-  // Set position
-  cursor_x = adjusted_x;
-  cursor_y = adjusted_y;
-  
-  // Draw the string using existing print method
-  print(string.c_str());
-  
-  // Restore original cursor position, size, and font
-  cursor_x = old_x;
-  cursor_y = old_y;
-  textsize = old_size;
-  gfxFont = old_font;
-  
-  return width;
-}
-
-// Draw string centered horizontally around x coordinate
-int16_t ILI9486_Display::drawCentreString(const char *string, int32_t x, int32_t y, uint8_t font) {
-  // Save current state
-  uint8_t old_size = textsize;
-  const GFXfont *old_font = gfxFont;
-  
-  // Font selection logic (same as drawString)
-  if (font == 0) {
-    // Use current font from setFreeFont()
-    textsize = old_size;
-  } else if (font == 1) {
-    // Explicitly select built-in 5x7 font
-    gfxFont = nullptr;
-    textsize = old_size;
-  } else if (font < 6) {
-    // Select from font array (indices 2-5)
-    if (fontArray[font] != nullptr) {
-      gfxFont = fontArray[font];
-      textsize = old_size;
-    } else {
-      // Font slot empty, fall back to built-in 5x7
-      gfxFont = nullptr;
-      textsize = old_size;
+    uint32_t fillBytes = totalBytes < lineBufferSize ? totalBytes : lineBufferSize;
+    uint8_t idx = colorBuffer(color, fillBytes);
+    lineBuf[idx].fence = _bus.queuePattern(lineBuf[idx].data, fillBytes, totalBytes);
+  }
+  endWrite();
+}
+
+// Send len pixels. Data already in panel byte order goes straight to the
+// bus; otherwise it is byte-swapped into the line buffers a chunk at a time,
+// and each chunk is converted while the previous one is on the wire.
+template <class Bus>
+void ILI9486_Driver<Bus>::pushPixels(const uint16_t *data, uint32_t len, bool swapBytes) {
+  if (len == 0 || streamIgnored()) return;
+  startWrite();
+  if (!swapBytes) {
+    _bus.writeBytes((const uint8_t *)data, len * 2);
+    if (_capturing) mirrorBytes((const uint8_t *)data, len * 2);
+  } else if (!lineBuf[0].data) {
+    for (uint32_t i = 0; i < len; i++) {
+      _bus.write16(data[i]);
+      if (_capturing) mirrorPixels(nullptr, data[i], 1);
     }
   } else {
-    // Out of bounds, fall back to built-in 5x7
-    gfxFont = nullptr;
-    textsize = old_size;
-  }
-  
-  // Calculate width to determine center offset
-  int16_t width = 0;
-  
-  if (gfxFont) {
-    // GFX font - sum character advances
-    const char *p = string;
-    while (*p) {
-      char c = *p++;
-      if (c >= gfxFont->first && c <= gfxFont->last) {
-        uint8_t glyph_index = c - gfxFont->first;
-        GFXglyph *glyph = &(((GFXglyph *)gfxFont->glyph)[glyph_index]);
-        width += pgm_read_byte(&glyph->xAdvance) * textsize;
+    uint32_t chunkPixels = lineBufferSize / 2;
+    while (len > 0) {
+      uint32_t n = len < chunkPixels ? len : chunkPixels;
+      uint8_t idx = acquireLineBuffer();
+      uint8_t *dst = lineBuf[idx].data;
+      for (uint32_t i = 0; i < n; i++) {
+        *dst++ = data[i] >> 8;
+        *dst++ = data[i] & 0xFF;
       }
+      lineBuf[idx].fillBytes = 0;
+      lineBuf[idx].fence = _bus.queueBytes(lineBuf[idx].data, n * 2);
+      if (_capturing) mirrorBytes(lineBuf[idx].data, n * 2);
+      data += n;
+      len -= n;
     }
-  } else {
-    // Built-in font - 6 pixels per char (5 + 1 spacing)
-    width = strlen(string) * 6 * textsize;
   }
-  
-  // Restore font and textsize
-  gfxFont = old_font;
-  textsize = old_size;
-  
-  // Draw centered by offsetting x by half the width
-  return drawString(String(string), x - (width / 2), y, font);
+  endWrite();
 }
 
-// Draw bitmap (1-bit per pixel, MSB first)
-void ILI9486_Display::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color) {
-  int16_t byteWidth = (w + 7) / 8;
-  uint8_t byte = 0;
-  
-  for (int16_t j = 0; j < h; j++) {
-    for (int16_t i = 0; i < w; i++) {
-      if (i & 7) {
-        byte <<= 1;
-      } else {
-        byte = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
-      }
-      if (byte & 0x80) {
-        drawPixel(x + i, y + j, color);
-      }
+// Primitives that are recorded as a single display list op. Drawing them
+// is left to ILI9486_GFX.
+template <class Bus>
+void ILI9486_Driver<Bus>::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  if (_drawMode == DRAW_RECORD) {
+    ListOp *op = listAdd(OP_LINE, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0);
+    if (op) {
+      op->v[0] = x0; op->v[1] = y0; op->v[2] = x1; op->v[3] = y1;
+      op->color = color;
     }
+    return;
   }
+  GFX::drawLine(x0, y0, x1, y1, color);
 }
 
-// Draw bitmap with background color
-void ILI9486_Display::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg) {
-  int16_t byteWidth = (w + 7) / 8;
-  uint8_t byte = 0;
-  
-  for (int16_t j = 0; j < h; j++) {
-    for (int16_t i = 0; i < w; i++) {
-      if (i & 7) {
-        byte <<= 1;
-      } else {
-        byte = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
-      }
-      if (byte & 0x80) {
-        drawPixel(x + i, y + j, color);
-      } else {
-        drawPixel(x + i, y + j, bg);
-      }
+template <class Bus>
+void ILI9486_Driver<Bus>::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  if (_drawMode == DRAW_RECORD) {
+    ListOp *op = listAdd(OP_CIRCLE, y0 - r, y0 + r);
+    if (op) {
+      op->v[0] = x0; op->v[1] = y0; op->v[2] = r;
+      op->color = color;
     }
+    return;
   }
+  GFX::drawCircle(x0, y0, r, color);
 }
 
+template <class Bus>
+void ILI9486_Driver<Bus>::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  if (_drawMode == DRAW_RECORD) {
+    ListOp *op = listAdd(OP_FILL_CIRCLE, y0 - r, y0 + r);
+    if (op) {
+      op->v[0] = x0; op->v[1] = y0; op->v[2] = r;
+      op->color = color;
+    }
+    return;
+  }
+  GFX::fillCircle(x0, y0, r, color);
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color) {
+  if (_drawMode == DRAW_RECORD) {
+    ListOp *op = listAdd(OP_BITMAP, y, y + h - 1);
+    if (op) {
+      op->v[0] = x; op->v[1] = y; op->v[2] = w; op->v[3] = h;
+      op->color = color;
+      op->ptr = bitmap;
+    }
+    return;
+  }
+  GFX::drawBitmap(x, y, bitmap, w, h, color);
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg) {
+  if (_drawMode == DRAW_RECORD) {
+    ListOp *op = listAdd(OP_BITMAP_BG, y, y + h - 1);
+    if (op) {
+      op->v[0] = x; op->v[1] = y; op->v[2] = w; op->v[3] = h;
+      op->color = color; op->bg = bg;
+      op->ptr = bitmap;
+    }
+    return;
+  }
+  GFX::drawBitmap(x, y, bitmap, w, h, color, bg);
+}
+
+// Built-in font characters are recorded here; with a GFX font drawChar()
+// hands over to drawGFXChar()
+template <class Bus>
+void ILI9486_Driver<Bus>::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  if (_drawMode == DRAW_RECORD && !this->gfxFont) {
+    if (c < 32 || c > 122) c = 32;
+    ListOp *op = listAdd(OP_CHAR, y, y + 8 * size - 1);
+    if (op) {
+      op->v[0] = x; op->v[1] = y;
+      op->c = c; op->size = size; op->opaque = this->use_bg;
+      op->color = color; op->bg = bg;
+      op->ptr = nullptr;
+    }
+    return;
+  }
+  GFX::drawChar(x, y, c, color, bg, size);
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::drawGFXChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  if (_drawMode == DRAW_RECORD) {
+    const GFXfont *font = this->gfxFont;
+    if (!font || c < font->first || c > font->last) return;
+    GFXglyph *glyph = &(((GFXglyph *)font->glyph)[c - font->first]);
+    uint8_t h = pgm_read_byte(&glyph->height);
+    int8_t yo = pgm_read_byte(&glyph->yOffset);
+    ListOp *op = listAdd(OP_CHAR, y + yo * size, y + (yo + h) * size - 1);
+    if (op) {
+      op->v[0] = x; op->v[1] = y;
+      op->c = c; op->size = size; op->opaque = this->use_bg;
+      op->color = color; op->bg = bg;
+      op->ptr = font;
+    }
+    return;
+  }
+  GFX::drawGFXChar(x, y, c, color, bg, size);
+}
+
+template <class Bus>
+void ILI9486_Driver<Bus>::pushImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *data) {
+  if (_drawMode == DRAW_RECORD) {
+    pushImageDMA(x, y, w, h, data);
+    return;
+  }
+  GFX::pushImage(x, y, w, h, data);
+}
+
+// Draw single pixel
+template <class Bus>
+void ILI9486_Driver<Bus>::drawPixel(uint16_t x, uint16_t y, uint16_t color) {
+  if (_drawMode == DRAW_RECORD) {
+    ListOp *op = listAdd(OP_PIXEL, y, y);
+    if (op) {
+      op->v[0] = x; op->v[1] = y;
+      op->color = color;
+    }
+    return;
+  }
+  if (x >= _width || y >= _height) return;
+  startWrite();
+  setAddrWindow(x, y, x, y);
+  writeData16(color);
+  if (_capturing) mirrorPixels(nullptr, color, 1);
+  endWrite();
+}
+
+// Runtime-pin display - pins chosen when the object is constructed
+class ILI9486_Display : public ILI9486_Driver<ILI9486_SPIBus<ILI9486_RuntimePins> > {
+public:
+  ILI9486_Display(int8_t cs, int8_t dc, int8_t rst, int8_t mosi, int8_t sclk)
+    : ILI9486_Driver<ILI9486_SPIBus<ILI9486_RuntimePins> >(
+        ILI9486_SPIBus<ILI9486_RuntimePins>(ILI9486_RuntimePins(cs, dc, rst), mosi, sclk)) {}
+};
+
+// Compile-time-pin display - CS/DC/RST toggles become direct GPIO register writes
+template <int8_t CS, int8_t DC, int8_t RST = -1>
+class ILI9486_FastDisplay : public ILI9486_Driver<ILI9486_SPIBus<ILI9486_StaticPins<CS, DC, RST> > > {
+public:
+  ILI9486_FastDisplay(int8_t mosi, int8_t sclk, SPIClass &spi = SPI)
+    : ILI9486_Driver<ILI9486_SPIBus<ILI9486_StaticPins<CS, DC, RST> > >(
+        ILI9486_SPIBus<ILI9486_StaticPins<CS, DC, RST> >(ILI9486_StaticPins<CS, DC, RST>(), mosi, sclk, spi)) {}
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Runtime-pin display on the ESP-IDF DMA transport - fillRectDMA()/pushImageDMA()
+// return while the data is still being clocked out
+class ILI9486_DMADisplay : public ILI9486_Driver<ILI9486_DMABus<ILI9486_RuntimePins> > {
+public:
+  ILI9486_DMADisplay(int8_t cs, int8_t dc, int8_t rst, int8_t mosi, int8_t sclk, spi_host_device_t host = SPI2_HOST)
+    : ILI9486_Driver<ILI9486_DMABus<ILI9486_RuntimePins> >(
+        ILI9486_DMABus<ILI9486_RuntimePins>(ILI9486_RuntimePins(cs, dc, rst), mosi, sclk, host)) {}
+};
+#endif
+
 #endif // ILI9486_DISPLAY_H
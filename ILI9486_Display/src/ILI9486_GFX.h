@@ -0,0 +1,1501 @@
+#ifndef ILI9486_GFX_H
+#define ILI9486_GFX_H
+
+#include <Arduino.h>
+
+// Helper for swapping values (a function rather than a "swap" macro, which
+// would clash with std::swap and the STL headers used by host builds)
+template <typename T>
+static inline void ili9486_swap(T &a, T &b) { T t = a; a = b; b = t; }
+
+// Simple 5x7 font (ASCII 32-126)
+static const uint8_t font5x7[] PROGMEM = {
+  0x00, 0x00, 0x00, 0x00, 0x00, // (space)
+  0x00, 0x00, 0x5F, 0x00, 0x00, // !
+  0x00, 0x07, 0x00, 0x07, 0x00, // "
+  0x14, 0x7F, 0x14, 0x7F, 0x14, // #
+  0x24, 0x2A, 0x7F, 0x2A, 0x12, // $
+  0x23, 0x13, 0x08, 0x64, 0x62, // %
+  0x36, 0x49, 0x55, 0x22, 0x50, // &
+  0x00, 0x05, 0x03, 0x00, 0x00, // '
+  0x00, 0x1C, 0x22, 0x41, 0x00, // (
+  0x00, 0x41, 0x22, 0x1C, 0x00, // )
+  0x08, 0x2A, 0x1C, 0x2A, 0x08, // *
+  0x08, 0x08, 0x3E, 0x08, 0x08, // +
+  0x00, 0x50, 0x30, 0x00, 0x00, // ,
+  0x08, 0x08, 0x08, 0x08, 0x08, // -
+  0x00, 0x60, 0x60, 0x00, 0x00, // .
+  0x20, 0x10, 0x08, 0x04, 0x02, // /
+  0x3E, 0x51, 0x49, 0x45, 0x3E, // 0
+  0x00, 0x42, 0x7F, 0x40, 0x00, // 1
+  0x42, 0x61, 0x51, 0x49, 0x46, // 2
+  0x21, 0x41, 0x45, 0x4B, 0x31, // 3
+  0x18, 0x14, 0x12, 0x7F, 0x10, // 4
+  0x27, 0x45, 0x45, 0x45, 0x39, // 5
+  0x3C, 0x4A, 0x49, 0x49, 0x30, // 6
+  0x01, 0x71, 0x09, 0x05, 0x03, // 7
+  0x36, 0x49, 0x49, 0x49, 0x36, // 8
+  0x06, 0x49, 0x49, 0x29, 0x1E, // 9
+  0x00, 0x36, 0x36, 0x00, 0x00, // :
+  0x00, 0x56, 0x36, 0x00, 0x00, // ;
+  0x00, 0x08, 0x14, 0x22, 0x41, // <
+  0x14, 0x14, 0x14, 0x14, 0x14, // =
+  0x41, 0x22, 0x14, 0x08, 0x00, // >
+  0x02, 0x01, 0x51, 0x09, 0x06, // ?
+  0x32, 0x49, 0x79, 0x41, 0x3E, // @
+  0x7E, 0x11, 0x11, 0x11, 0x7E, // A
+  0x7F, 0x49, 0x49, 0x49, 0x36, // B
+  0x3E, 0x41, 0x41, 0x41, 0x22, // C
+  0x7F, 0x41, 0x41, 0x22, 0x1C, // D
+  0x7F, 0x49, 0x49, 0x49, 0x41, // E
+  0x7F, 0x09, 0x09, 0x01, 0x01, // F
+  0x3E, 0x41, 0x41, 0x51, 0x32, // G
+  0x7F, 0x08, 0x08, 0x08, 0x7F, // H
+  0x00, 0x41, 0x7F, 0x41, 0x00, // I
+  0x20, 0x40, 0x41, 0x3F, 0x01, // J
+  0x7F, 0x08, 0x14, 0x22, 0x41, // K
+  0x7F, 0x40, 0x40, 0x40, 0x40, // L
+  0x7F, 0x02, 0x04, 0x02, 0x7F, // M
+  0x7F, 0x04, 0x08, 0x10, 0x7F, // N
+  0x3E, 0x41, 0x41, 0x41, 0x3E, // O
+  0x7F, 0x09, 0x09, 0x09, 0x06, // P
+  0x3E, 0x41, 0x51, 0x21, 0x5E, // Q
+  0x7F, 0x09, 0x19, 0x29, 0x46, // R
+  0x46, 0x49, 0x49, 0x49, 0x31, // S
+  0x01, 0x01, 0x7F, 0x01, 0x01, // T
+  0x3F, 0x40, 0x40, 0x40, 0x3F, // U
+  0x1F, 0x20, 0x40, 0x20, 0x1F, // V
+  0x7F, 0x20, 0x18, 0x20, 0x7F, // W
+  0x63, 0x14, 0x08, 0x14, 0x63, // X
+  0x03, 0x04, 0x78, 0x04, 0x03, // Y
+  0x61, 0x51, 0x49, 0x45, 0x43, // Z
+  0x00, 0x00, 0x7F, 0x41, 0x41, // [
+  0x02, 0x04, 0x08, 0x10, 0x20, // backslash
+  0x41, 0x41, 0x7F, 0x00, 0x00, // ]
+  0x04, 0x02, 0x01, 0x02, 0x04, // ^
+  0x40, 0x40, 0x40, 0x40, 0x40, // _
+  0x00, 0x01, 0x02, 0x04, 0x00, // `
+  0x20, 0x54, 0x54, 0x54, 0x78, // a
+  0x7F, 0x48, 0x44, 0x44, 0x38, // b
+  0x38, 0x44, 0x44, 0x44, 0x20, // c
+  0x38, 0x44, 0x44, 0x48, 0x7F, // d
+  0x38, 0x54, 0x54, 0x54, 0x18, // e
+  0x08, 0x7E, 0x09, 0x01, 0x02, // f
+  0x0C, 0x52, 0x52, 0x52, 0x3E, // g
+  0x7F, 0x08, 0x04, 0x04, 0x78, // h
+  0x00, 0x44, 0x7D, 0x40, 0x00, // i
+  0x20, 0x40, 0x44, 0x3D, 0x00, // j
+  0x00, 0x7F, 0x10, 0x28, 0x44, // k
+  0x00, 0x41, 0x7F, 0x40, 0x00, // l
+  0x7C, 0x04, 0x18, 0x04, 0x78, // m
+  0x7C, 0x08, 0x04, 0x04, 0x78, // n
+  0x38, 0x44, 0x44, 0x44, 0x38, // o
+  0x7C, 0x14, 0x14, 0x14, 0x08, // p
+  0x08, 0x14, 0x14, 0x18, 0x7C, // q
+  0x7C, 0x08, 0x04, 0x04, 0x08, // r
+  0x48, 0x54, 0x54, 0x54, 0x20, // s
+  0x04, 0x3F, 0x44, 0x40, 0x20, // t
+  0x3C, 0x40, 0x40, 0x20, 0x7C, // u
+  0x1C, 0x20, 0x40, 0x20, 0x1C, // v
+  0x3C, 0x40, 0x30, 0x40, 0x3C, // w
+  0x44, 0x28, 0x10, 0x28, 0x44, // x
+  0x0C, 0x50, 0x50, 0x50, 0x3C, // y
+  0x44, 0x64, 0x54, 0x4C, 0x44, // z
+};
+
+// Color definitions (RGB565 format)
+#define TFT_BLACK       0x0000
+#define TFT_WHITE       0xFFFF
+#define TFT_RED         0xF800
+#define TFT_GREEN       0x07E0
+#define TFT_BLUE        0x001F
+#define TFT_CYAN        0x07FF
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_ORANGE      0xFD20
+#define TFT_GREENYELLOW 0xAFE5
+#define TFT_DARKGREY    0x7BEF
+#define TFT_LIGHTGREY   0xC618
+
+// Text datum definitions (Bodmer TFT_eSPI compatible)
+#define TL_DATUM 0  // Top Left
+#define TC_DATUM 1  // Top Center
+#define TR_DATUM 2  // Top Right
+#define ML_DATUM 3  // Middle Left
+#define MC_DATUM 4  // Middle Center
+#define MR_DATUM 5  // Middle Right
+#define BL_DATUM 6  // Bottom Left (baseline)
+#define BC_DATUM 7  // Bottom Center
+#define BR_DATUM 8  // Bottom Right
+
+// GFX font structures (Adafruit GFX format)
+typedef struct {
+  uint16_t bitmapOffset;     // Pointer into GFXfont->bitmap
+  uint8_t  width, height;    // Bitmap dimensions in pixels
+  uint8_t  xAdvance;         // Distance to advance cursor (x axis)
+  int8_t   xOffset, yOffset; // Dist from cursor pos to UL corner
+} GFXglyph;
+
+typedef struct {
+  uint8_t  *bitmap;      // Glyph bitmaps, concatenated
+  GFXglyph *glyph;       // Glyph array
+  uint8_t   first, last; // ASCII extents
+  uint8_t   yAdvance;    // Newline distance (y axis)
+} GFXfont;
+
+
+// Quarter-wave sine table, sin(0 .. 90 degrees) x 16384
+static const int16_t ili9486_sin90[91] PROGMEM = {
+  0, 286, 572, 857, 1143, 1428, 1713, 1997, 2280, 2563,
+  2845, 3126, 3406, 3686, 3964, 4240, 4516, 4790, 5063, 5334,
+  5604, 5872, 6138, 6402, 6664, 6924, 7182, 7438, 7692, 7943,
+  8192, 8438, 8682, 8923, 9162, 9397, 9630, 9860, 10087, 10311,
+  10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+  12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+  14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+  15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+  16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+  16384,
+};
+
+// sin(deg) x 16384, for whole degrees
+static inline int32_t ili9486_sin(int32_t deg) {
+  deg %= 360;
+  if (deg < 0) deg += 360;
+  if (deg <= 90) return (int16_t)pgm_read_word(&ili9486_sin90[deg]);
+  if (deg <= 180) return (int16_t)pgm_read_word(&ili9486_sin90[180 - deg]);
+  if (deg <= 270) return -(int16_t)pgm_read_word(&ili9486_sin90[deg - 180]);
+  return -(int16_t)pgm_read_word(&ili9486_sin90[360 - deg]);
+}
+
+// Rows of an rx x ry ellipse, walked from the centre outwards. A pixel
+// belongs to the ellipse when its centre lies inside the ellipse grown by
+// half a pixel:
+//
+//   (2dx)^2 (2ry+1)^2 + (2dy)^2 (2rx+1)^2 <= (2rx+1)^2 (2ry+1)^2
+//
+// which for a circle is dx^2 + dy^2 <= r^2 + r. next() returns the
+// half-width of each row in turn and -1 past the last one. The half-width
+// only shrinks, so the whole walk takes rx + ry integer steps.
+class ILI9486_EllipseRows {
+public:
+  static const int16_t MAX_RADIUS = 16383;   // Keeps the terms within 64 bits
+  
+  ILI9486_EllipseRows(int16_t rx, int16_t ry)
+    : _a((int64_t)(2 * rx + 1) * (2 * rx + 1)), _b((int64_t)(2 * ry + 1) * (2 * ry + 1)),
+      _ry(ry), _dy(-1), _hw(rx) {}
+  
+  int32_t next() {
+    if (_dy >= _ry) return -1;
+    _dy++;
+    int64_t room = _a * _b - 4 * (int64_t)_dy * _dy * _a;
+    while (_hw > 0 && 4 * (int64_t)_hw * _hw * _b > room) _hw--;
+    return _hw;
+  }
+  
+private:
+  int64_t _a, _b;
+  int32_t _ry, _dy, _hw;
+};
+
+// Angular range of an arc or pie slice. Angles are whole degrees clockwise
+// from 12 o'clock, and the range runs clockwise from start to end. Equal
+// angles give an empty range, ends 360 or more apart the whole circle.
+class ILI9486_Sector {
+public:
+  ILI9486_Sector(int16_t start, int16_t end) {
+    int32_t span = (int32_t)end - start;
+    _empty = span == 0;
+    _full = span >= 360 || span <= -360;
+    span %= 360;
+    if (span < 0) span += 360;
+    _wide = span > 180;
+    _ux0 = ili9486_sin(start);
+    _uy0 = -ili9486_sin(start + 90);
+    _ux1 = ili9486_sin(end);
+    _uy1 = -ili9486_sin(end + 90);
+  }
+  
+  bool empty() const { return _empty; }
+  bool full() const { return _full; }
+  
+  // Whether the pixel dx, dy from the centre (screen axes) is in range. The
+  // centre always is.
+  bool contains(int32_t dx, int32_t dy) const {
+    int32_t c0 = _ux0 * dy - _uy0 * dx;   // >= 0: clockwise of the start ray
+    int32_t c1 = dx * _uy1 - dy * _ux1;   // >= 0: anticlockwise of the end ray
+    return _wide ? (c0 >= 0 || c1 >= 0) : (c0 >= 0 && c1 >= 0);
+  }
+  
+private:
+  int32_t _ux0, _uy0, _ux1, _uy1;         // Ray directions x 16384
+  bool _wide, _empty, _full;
+};
+
+// Shape, text and bitmap drawing, written once for every drawing target.
+//
+// Target derives from ILI9486_GFX<Target> (curiously recurring template) and
+// provides the sinks the algorithms are built on:
+//
+//   uint16_t width(), height()
+//   void fillRect(x, y, w, h, color)              Solid span or block
+//   void drawPixel(x, y, color)
+//   void pushRows(x, y, w, h, renderRow)          Block produced row by row,
+//                                                 see ILI9486_Driver::pushRows()
+//   void startWrite(), endWrite()                 Batch a sequence of the above
+//
+// Calls into the target are resolved at compile time, so a span costs the
+// same as if the algorithm had been written against the target directly.
+// A target can also replace any of the algorithms (the driver does, to
+// record display list ops) and the others pick that up.
+//
+// ILI9486_Driver draws to the panel this way, ILI9486_RamCanvas to a
+// buffer in RAM.
+template <class Target>
+class ILI9486_GFX {
+public:
+  ILI9486_GFX();
+  
+  void fillScreen(uint16_t color) { self().fillRect(0, 0, self().width(), self().height(), color); }
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  
+  // Round shapes, sent as horizontal spans: one fill per span and no pixel
+  // written twice. Radii go up to ILI9486_EllipseRows::MAX_RADIUS. Arc and
+  // pie angles are in degrees, clockwise from 12 o'clock (see
+  // ILI9486_Sector); fillArc() draws the ring from radius ir out to r.
+  void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+  void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+  void drawEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t color);
+  void fillEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t color);
+  void drawArc(int16_t x0, int16_t y0, int16_t r, int16_t start, int16_t end, uint16_t color);
+  void fillArc(int16_t x0, int16_t y0, int16_t r, int16_t ir, int16_t start, int16_t end, uint16_t color);
+  void fillPie(int16_t x0, int16_t y0, int16_t r, int16_t start, int16_t end, uint16_t color) { self().fillArc(x0, y0, r, 0, start, end, color); }
+  
+  // Bitmap drawing
+  void drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg);
+  
+  // RGB565 image in panel byte order. Rows that fall off the bottom are
+  // dropped, images that do not fit horizontally are rejected.
+  void pushImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *data);
+  
+  // Font rendering
+  void setFreeFont(const GFXfont *f = NULL);
+  void setCursor(uint16_t x, uint16_t y);
+  void setTextColor(uint16_t color);
+  void setTextColor(uint16_t fg, uint16_t bg);
+  void setTextSize(uint8_t s);
+  void setTextDatum(uint8_t datum);
+  void print(const char *str);
+  void print(int num);
+  void print(unsigned long num);
+  void print(float num, int decimals = 2);
+  void println(const char *str);
+  void println(int num);
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+  void drawGFXChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+  
+  // String drawing with positioning
+  int16_t drawString(const String &string, int32_t x, int32_t y, uint8_t font = 0);
+  int16_t drawCentreString(const char *string, int32_t x, int32_t y, uint8_t font = 0);
+  
+  // Color conversion
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+  }
+  
+  // Mix fg over bg, alpha 0 (bg) .. 255 (fg)
+  uint16_t alphaBlend(uint8_t alpha, uint16_t fg, uint16_t bg) {
+    uint16_t r = ((fg >> 11) * alpha + (bg >> 11) * (255 - alpha)) / 255;
+    uint16_t g = (((fg >> 5) & 0x3F) * alpha + ((bg >> 5) & 0x3F) * (255 - alpha)) / 255;
+    uint16_t b = ((fg & 0x1F) * alpha + (bg & 0x1F) * (255 - alpha)) / 255;
+    return (r << 11) | (g << 5) | b;
+  }
+  
+  // Font array for indexed font selection (public for user configuration)
+  const GFXfont* fontArray[6];  // Indices: 0=current, 1=builtin, 2-5=user fonts
+  
+protected:
+  const GFXfont *gfxFont;
+  uint16_t cursor_x, cursor_y;
+  uint16_t textcolor, textbgcolor;
+  uint8_t textsize;
+  uint8_t textdatum;
+  bool use_bg;
+  
+  Target &self() { return static_cast<Target &>(*this); }
+  
+private:
+  void strokeEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, const ILI9486_Sector *sector, uint16_t color);
+  void ringRows(int32_t cx, int32_t cy, int32_t dy, int32_t inner, int32_t outer, const ILI9486_Sector *sector, uint16_t color);
+  void arcSpan(int32_t cx, int32_t y, int32_t dx0, int32_t dx1, int32_t dy, const ILI9486_Sector *sector, uint16_t color);
+  void span(int32_t x0, int32_t x1, int32_t y, uint16_t color);
+};
+
+template <class Target>
+ILI9486_GFX<Target>::ILI9486_GFX() {
+  gfxFont = nullptr;
+  cursor_x = 0;
+  cursor_y = 0;
+  textcolor = TFT_WHITE;
+  textbgcolor = TFT_BLACK;
+  textsize = 1;
+  textdatum = TL_DATUM;  // Default to Top-Left
+  use_bg = false;
+  
+  // Initialize font array
+  for (int i = 0; i < 6; i++) {
+    fontArray[i] = nullptr;
+  }
+}
+
+// Draw rectangle outline: two full-width rows and the sides between them,
+// so no pixel is written twice
+template <class Target>
+void ILI9486_GFX<Target>::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (w <= 0 || h <= 0) return;
+  self().startWrite();
+  self().drawFastHLine(x, y, w, color);
+  if (h > 1) self().drawFastHLine(x, y + h - 1, w, color);
+  if (h > 2) {
+    self().drawFastVLine(x, y + 1, h - 2, color);
+    if (w > 1) self().drawFastVLine(x + w - 1, y + 1, h - 2, color);
+  }
+  self().endWrite();
+}
+
+// Fast horizontal line, clipped with signed coordinates
+template <class Target>
+void ILI9486_GFX<Target>::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if (y < 0 || y >= self().height() || w <= 0) return;
+  int32_t x0 = x > 0 ? x : 0;
+  int32_t x1 = (int32_t)x + w < self().width() ? (int32_t)x + w : self().width();
+  if (x1 > x0) self().fillRect(x0, y, x1 - x0, 1, color);
+}
+
+// Fast vertical line, clipped with signed coordinates
+template <class Target>
+void ILI9486_GFX<Target>::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  if (x < 0 || x >= self().width() || h <= 0) return;
+  int32_t y0 = y > 0 ? y : 0;
+  int32_t y1 = (int32_t)y + h < self().height() ? (int32_t)y + h : self().height();
+  if (y1 > y0) self().fillRect(x, y0, 1, y1 - y0, color);
+}
+
+// Draw line. Axis-aligned lines go to the fast lines. Others are stepped
+// along their major axis by Bresenham, clipped to the screen first, and
+// every run of pixels on the same row (or column, for steep lines) is
+// written as one fill instead of pixel by pixel.
+template <class Target>
+void ILI9486_GFX<Target>::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  // Clip the ends to the screen first: the length of a line spanning more
+  // than 32767 pixels does not fit the fast lines' int16_t
+  if (y0 == y1) {
+    if (x0 > x1) ili9486_swap(x0, x1);
+    if (x0 < 0) x0 = 0;
+    if (x1 >= (int16_t)self().width()) x1 = self().width() - 1;
+    if (x1 >= x0) self().drawFastHLine(x0, y0, x1 - x0 + 1, color);
+    return;
+  }
+  if (x0 == x1) {
+    if (y0 > y1) ili9486_swap(y0, y1);
+    if (y0 < 0) y0 = 0;
+    if (y1 >= (int16_t)self().height()) y1 = self().height() - 1;
+    if (y1 >= y0) self().drawFastVLine(x0, y0, y1 - y0 + 1, color);
+    return;
+  }
+  
+  // Work in (major, minor) coordinates, stepping the major one upwards
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  int32_t a0 = steep ? y0 : x0, b0 = steep ? x0 : y0;
+  int32_t a1 = steep ? y1 : x1, b1 = steep ? x1 : y1;
+  if (a0 > a1) {
+    ili9486_swap(a0, a1);
+    ili9486_swap(b0, b1);
+  }
+  int32_t majorEnd = steep ? self().height() : self().width();
+  int32_t minorEnd = steep ? self().width() : self().height();
+  if (a1 < 0 || a0 >= majorEnd || (b0 < 0 && b1 < 0) || (b0 >= minorEnd && b1 >= minorEnd)) return;
+  
+  int32_t da = a1 - a0;
+  int32_t db = abs(b1 - b0);
+  int32_t step = b0 < b1 ? 1 : -1;
+  
+  // Jump to the first on-screen column of the major axis: after i steps the
+  // minor coordinate has moved k times, k being the smallest count that
+  // keeps the error term da / 2 - i * db + k * da non-negative
+  int32_t i = a0 < 0 ? -a0 : 0;
+  int64_t num = (int64_t)i * db - da / 2;
+  int32_t k = num <= 0 ? 0 : (num + da - 1) / da;
+  int32_t err = da / 2 - (int64_t)i * db + (int64_t)k * da;
+  int32_t a = a0 + i, b = b0 + step * k;
+  int32_t aEnd = a1 < majorEnd ? a1 : majorEnd - 1;
+  
+  self().startWrite();
+  int32_t runStart = a;
+  for (; a <= aEnd; a++) {
+    err -= db;
+    if (err < 0 || a == aEnd) {
+      // Run of this minor coordinate ends here
+      if (b >= 0 && b < minorEnd) {
+        if (steep) {
+          self().fillRect(b, runStart, 1, a - runStart + 1, color);
+        } else {
+          self().fillRect(runStart, b, a - runStart + 1, 1, color);
+        }
+      } else if ((step > 0) == (b >= minorEnd)) {
+        break;  // Left the screen for good
+      }
+      if (err < 0) {
+        b += step;
+        err += da;
+      }
+      runStart = a + 1;
+    }
+  }
+  self().endWrite();
+}
+
+// Draw circle
+template <class Target>
+void ILI9486_GFX<Target>::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  strokeEllipse(x0, y0, r, r, nullptr, color);
+}
+
+// Fill circle
+template <class Target>
+void ILI9486_GFX<Target>::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  fillEllipse(x0, y0, r, r, color);
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::drawEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t color) {
+  strokeEllipse(x0, y0, rx, ry, nullptr, color);
+}
+
+// One span per row
+template <class Target>
+void ILI9486_GFX<Target>::fillEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, uint16_t color) {
+  if (rx < 0 || ry < 0 || rx > ILI9486_EllipseRows::MAX_RADIUS || ry > ILI9486_EllipseRows::MAX_RADIUS) return;
+  ILI9486_EllipseRows rows(rx, ry);
+  self().startWrite();
+  int32_t hw;
+  for (int32_t dy = 0; (hw = rows.next()) >= 0; dy++) {
+    if (y0 - dy < 0 && y0 + dy >= self().height()) break;
+    ringRows(x0, y0, dy, 0, hw, nullptr, color);
+  }
+  self().endWrite();
+}
+
+// Arc of the circle outline
+template <class Target>
+void ILI9486_GFX<Target>::drawArc(int16_t x0, int16_t y0, int16_t r, int16_t start, int16_t end, uint16_t color) {
+  ILI9486_Sector sector(start, end);
+  if (!sector.empty()) strokeEllipse(x0, y0, r, r, &sector, color);
+}
+
+// Ring segment: inside radius r, outside the disc of radius ir - 1
+template <class Target>
+void ILI9486_GFX<Target>::fillArc(int16_t x0, int16_t y0, int16_t r, int16_t ir, int16_t start, int16_t end, uint16_t color) {
+  if (r < 0 || r > ILI9486_EllipseRows::MAX_RADIUS || ir > r) return;
+  ILI9486_Sector sector(start, end);
+  if (sector.empty()) return;
+  if (ir < 0) ir = 0;
+  ILI9486_EllipseRows outer(r, r), hole(ir - 1, ir - 1);
+  self().startWrite();
+  int32_t hw;
+  for (int32_t dy = 0; (hw = outer.next()) >= 0; dy++) {
+    int32_t inner = hole.next() + 1;    // 0 once past the hole
+    if (y0 - dy < 0 && y0 + dy >= self().height()) break;
+    ringRows(x0, y0, dy, inner, hw, &sector, color);
+  }
+  self().endWrite();
+}
+
+// Outline: on each row, the outermost pixel and whatever it takes to reach
+// the outermost pixel of the next row out, so the outline has no gaps
+template <class Target>
+void ILI9486_GFX<Target>::strokeEllipse(int16_t x0, int16_t y0, int16_t rx, int16_t ry, const ILI9486_Sector *sector, uint16_t color) {
+  if (rx < 0 || ry < 0 || rx > ILI9486_EllipseRows::MAX_RADIUS || ry > ILI9486_EllipseRows::MAX_RADIUS) return;
+  ILI9486_EllipseRows rows(rx, ry);
+  self().startWrite();
+  int32_t hw = rows.next();
+  for (int32_t dy = 0; hw >= 0; dy++) {
+    int32_t next = rows.next();
+    if (y0 - dy < 0 && y0 + dy >= self().height()) break;
+    ringRows(x0, y0, dy, next + 1 < hw ? next + 1 : hw, hw, sector, color);
+    hw = next;
+  }
+  self().endWrite();
+}
+
+// Pixels inner <= |dx| <= outer of the rows dy above and below the centre
+template <class Target>
+void ILI9486_GFX<Target>::ringRows(int32_t cx, int32_t cy, int32_t dy, int32_t inner, int32_t outer, const ILI9486_Sector *sector, uint16_t color) {
+  for (int32_t rowDy = -dy; ; rowDy = dy) {
+    int32_t y = cy + rowDy;
+    if (y >= 0 && y < self().height()) {
+      if (inner <= 0) {
+        arcSpan(cx, y, -outer, outer, rowDy, sector, color);
+      } else {
+        arcSpan(cx, y, -outer, -inner, rowDy, sector, color);
+        arcSpan(cx, y, inner, outer, rowDy, sector, color);
+      }
+    }
+    if (rowDy == dy) break;
+  }
+}
+
+// Span dx0 .. dx1 of row y (dy from the centre), cut down to the runs that
+// lie in the sector
+template <class Target>
+void ILI9486_GFX<Target>::arcSpan(int32_t cx, int32_t y, int32_t dx0, int32_t dx1, int32_t dy, const ILI9486_Sector *sector, uint16_t color) {
+  if (!sector || sector->full()) {
+    span(cx + dx0, cx + dx1, y, color);
+    return;
+  }
+  if (cx + dx0 < 0) dx0 = -cx;
+  if (cx + dx1 >= self().width()) dx1 = self().width() - 1 - cx;
+  int32_t run = 0;
+  bool in = false;
+  for (int32_t dx = dx0; dx <= dx1; dx++) {
+    bool c = sector->contains(dx, dy);
+    if (c && !in) run = dx;
+    if (!c && in) span(cx + run, cx + dx - 1, y, color);
+    in = c;
+  }
+  if (in) span(cx + run, cx + dx1, y, color);
+}
+
+// Span x0 .. x1 of row y, clipped to the screen
+template <class Target>
+void ILI9486_GFX<Target>::span(int32_t x0, int32_t x1, int32_t y, uint16_t color) {
+  if (y < 0 || y >= self().height()) return;
+  if (x0 < 0) x0 = 0;
+  if (x1 >= self().width()) x1 = self().width() - 1;
+  if (x1 >= x0) self().fillRect(x0, y, x1 - x0 + 1, 1, color);
+}
+
+// Font functions
+template <class Target>
+void ILI9486_GFX<Target>::setFreeFont(const GFXfont *f) {
+  gfxFont = (GFXfont *)f;
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::setTextSize(uint8_t s) {
+  textsize = (s > 0) ? s : 1;
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::setTextDatum(uint8_t datum) {
+  textdatum = datum;
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::setCursor(uint16_t x, uint16_t y) {
+  cursor_x = x;
+  cursor_y = y;
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::setTextColor(uint16_t color) {
+  textcolor = color;
+  use_bg = false;
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::setTextColor(uint16_t fg, uint16_t bg) {
+  textcolor = fg;
+  textbgcolor = bg;
+  use_bg = true;
+}
+
+// Draw character using GFX font - HIGHLY OPTIMIZED with horizontal runs and smooth edges
+template <class Target>
+void ILI9486_GFX<Target>::drawGFXChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  if (!gfxFont) return;
+  
+  c -= gfxFont->first;
+  if (c > (gfxFont->last - gfxFont->first)) return;
+  
+  GFXglyph *glyph = &(((GFXglyph *)gfxFont->glyph)[c]);
+  uint8_t *bitmap = gfxFont->bitmap;
+  
+  uint16_t bo = pgm_read_word(&glyph->bitmapOffset);
+  uint8_t w = pgm_read_byte(&glyph->width);
+  uint8_t h = pgm_read_byte(&glyph->height);
+  int8_t xo = pgm_read_byte(&glyph->xOffset);
+  int8_t yo = pgm_read_byte(&glyph->yOffset);
+  
+  // Opaque glyphs are expanded straight into the line buffers and sent as
+  // one window, background and foreground together
+  if (use_bg) {
+    uint8_t fhi = color >> 8, flo = color & 0xFF;
+    uint8_t bhi = bg >> 8, blo = bg & 0xFF;
+    self().pushRows(x + xo * size, y + yo * size, w * size, h * size,
+      [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+        uint32_t rowBit = (uint32_t)bo * 8 + (uint32_t)(row / size) * w;
+        for (uint16_t i = 0; i < count; i++) {
+          uint32_t b = rowBit + (col + i) / size;
+          bool on = pgm_read_byte(&bitmap[b >> 3]) & (0x80 >> (b & 7));
+          *dst++ = on ? fhi : bhi;
+          *dst++ = on ? flo : blo;
+        }
+      });
+    return;
+  }
+  
+  self().startWrite();
+  if (size == 1) {
+    // Draw using horizontal runs for speed
+    uint8_t bits = 0, bit = 0;
+    uint16_t bitOffset = bo;
+    
+    for (uint8_t yy = 0; yy < h; yy++) {
+      int16_t runStart = -1;
+      
+      for (uint8_t xx = 0; xx < w; xx++) {
+        if (!(bit++ & 7)) {
+          bits = pgm_read_byte(&bitmap[bitOffset++]);
+        }
+        
+        if (bits & 0x80) {
+          // Pixel is ON
+          if (runStart < 0) {
+            runStart = xx; // Start new run
+          }
+        } else {
+          // Pixel is OFF
+          if (runStart >= 0) {
+            // End of run - draw it with fillRect for perfect edges
+            self().fillRect(x + xo + runStart, y + yo + yy, xx - runStart, 1, color);
+            runStart = -1;
+          }
+        }
+        bits <<= 1;
+      }
+      
+      // Draw any remaining run at end of row
+      if (runStart >= 0) {
+        self().fillRect(x + xo + runStart, y + yo + yy, w - runStart, 1, color);
+      }
+    }
+  } else {
+    // Scaled characters - use original method
+    uint8_t bits = 0, bit = 0;
+    uint16_t bitOffset = bo;
+    
+    for (uint8_t yy = 0; yy < h; yy++) {
+      for (uint8_t xx = 0; xx < w; xx++) {
+        if (!(bit++ & 7)) {
+          bits = pgm_read_byte(&bitmap[bitOffset++]);
+        }
+        if (bits & 0x80) {
+          self().fillRect(x + (xo + xx) * size, y + (yo + yy) * size, size, size, color);
+        }
+        bits <<= 1;
+      }
+    }
+  }
+  self().endWrite();
+}
+
+// Draw character (simple 5x7 font or GFX font)
+template <class Target>
+void ILI9486_GFX<Target>::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  if (gfxFont) {
+    self().drawGFXChar(x, y, c, color, bg, size);
+    return;
+  }
+  
+  // Built-in 5x7 font
+  if (c < 32 || c > 122) c = 32; // Limit to printable ASCII
+  
+  const uint8_t *glyph = &font5x7[(c - 32) * 5];
+  
+  // Opaque: expand the whole 5x8 cell into the line buffers as one window
+  if (use_bg) {
+    uint8_t fhi = color >> 8, flo = color & 0xFF;
+    uint8_t bhi = bg >> 8, blo = bg & 0xFF;
+    self().pushRows(x, y, 5 * size, 8 * size,
+      [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+        uint8_t mask = 1 << (row / size);
+        for (uint16_t i = 0; i < count; i++) {
+          bool on = pgm_read_byte(&glyph[(col + i) / size]) & mask;
+          *dst++ = on ? fhi : bhi;
+          *dst++ = on ? flo : blo;
+        }
+      });
+    return;
+  }
+  
+  // Set pixels of each column are drawn as vertical runs
+  self().startWrite();
+  for (int8_t i = 0; i < 5; i++) {
+    uint8_t line = pgm_read_byte(&glyph[i]);
+    int8_t j = 0;
+    while (line) {
+      if (!(line & 0x1)) {
+        line >>= 1;
+        j++;
+        continue;
+      }
+      int8_t start = j;
+      while (line & 0x1) {
+        line >>= 1;
+        j++;
+      }
+      self().fillRect(x + i * size, y + start * size, size, (j - start) * size, color);
+    }
+  }
+  self().endWrite();
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::print(const char *str) {
+  self().startWrite();
+  if (gfxFont) {
+    // GFX font
+    while (*str) {
+      char c = *str++;
+      if (c == '\n') {
+        cursor_x = 0;
+        cursor_y += gfxFont->yAdvance * textsize;
+        continue;
+      }
+      if (c < gfxFont->first || c > gfxFont->last) continue;
+      
+      uint8_t glyph_index = c - gfxFont->first;
+      GFXglyph *glyph = &(((GFXglyph *)gfxFont->glyph)[glyph_index]);
+      self().drawGFXChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+      cursor_x += pgm_read_byte(&glyph->xAdvance) * textsize;
+    }
+  } else {
+    // Built-in font
+    while (*str) {
+      if (*str == '\n') {
+        cursor_x = 0;
+        cursor_y += 8 * textsize;
+        str++;
+        continue;
+      }
+      self().drawChar(cursor_x, cursor_y, *str++, textcolor, textbgcolor, textsize);
+      cursor_x += 6 * textsize;
+    }
+  }
+  self().endWrite();
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::print(int num) {
+  char buf[12];
+  itoa(num, buf, 10);
+  print(buf);
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::print(unsigned long num) {
+  char buf[12];
+  ultoa(num, buf, 10);
+  print(buf);
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::print(float num, int decimals) {
+  char buf[20];
+  dtostrf(num, 0, decimals, buf);
+  print(buf);
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::println(const char *str) {
+  print(str);
+  cursor_x = 0;
+  if (gfxFont) {
+    cursor_y += gfxFont->yAdvance * textsize;
+  } else {
+    cursor_y += 8 * textsize;
+  }
+}
+
+template <class Target>
+void ILI9486_GFX<Target>::println(int num) {
+  print(num);
+  cursor_x = 0;
+  if (gfxFont) {
+    cursor_y += gfxFont->yAdvance * textsize;
+  } else {
+    cursor_y += 8 * textsize;
+  }
+}
+
+// Draw string at specific position, restore cursor, return width
+template <class Target>
+int16_t ILI9486_GFX<Target>::drawString(const String &string, int32_t x, int32_t y, uint8_t font) {
+  // Save current state
+  uint16_t old_x = cursor_x;
+  uint16_t old_y = cursor_y;
+  uint8_t old_size = textsize;
+  const GFXfont *old_font = gfxFont;
+  
+  // Font selection logic
+  if (font == 0) {
+    // Use current font from setFreeFont() (could be nullptr for built-in 5x7)
+    // gfxFont already set, no change needed
+    textsize = old_size;  // Keep current textsize
+  } else if (font == 1) {
+    // Explicitly select built-in 5x7 font
+    gfxFont = nullptr;
+    textsize = old_size;  // Allow scaling
+  } else if (font < 6) {
+    // Select from font array (indices 2-5)
+    if (fontArray[font] != nullptr) {
+      gfxFont = fontArray[font];
+      textsize = old_size;  // Allow scaling
+    } else {
+      // Font slot empty, fall back to built-in 5x7
+      gfxFont = nullptr;
+      textsize = old_size;
+    }
+  } else {
+    // Out of bounds, fall back to built-in 5x7
+    gfxFont = nullptr;
+    textsize = old_size;
+  }
+  
+  // Calculate width and height before drawing
+  int16_t width = 0;
+  int16_t height = 0;
+  int16_t ascent = 0;
+  
+  if (gfxFont) {
+    // GFX font - calculate bounds
+    int16_t minY = 127, maxY = -128;  // Track min/max Y offsets
+    
+    for (unsigned int i = 0; i < string.length(); i++) {
+      char c = string[i];
+      if (c >= gfxFont->first && c <= gfxFont->last) {
+        uint8_t glyph_index = c - gfxFont->first;
+        GFXglyph *glyph = &(((GFXglyph *)gfxFont->glyph)[glyph_index]);
+        width += pgm_read_byte(&glyph->xAdvance) * textsize;
+        
+        // Track Y bounds for height calculation
+        int8_t yo = pgm_read_byte(&glyph->yOffset);
+        uint8_t h = pgm_read_byte(&glyph->height);
+        if (yo < minY) minY = yo;
+        if (yo + h > maxY) maxY = yo + h;
+      }
+    }
+    
+    ascent = -minY * textsize;   // Distance above baseline (minY is negative)
+    height = (maxY - minY) * textsize;
+  } else {
+    // Built-in font - 6 pixels per char (5 + 1 spacing), 8 pixels tall
+    width = string.length() * 6 * textsize;
+    height = 8 * textsize;
+    ascent = height;  // All above baseline for built-in font
+  }
+  
+  // Apply datum positioning
+  int16_t adjusted_x = x;
+  int16_t adjusted_y = y;
+  
+  // Horizontal adjustment based on datum
+  uint8_t h_datum = textdatum % 3;  // 0=Left, 1=Center, 2=Right
+  if (h_datum == 1) {
+    adjusted_x -= width / 2;  // Center
+  } else if (h_datum == 2) {
+    adjusted_x -= width;  // Right
+  }
+  
+  // Vertical adjustment based on datum
+  uint8_t v_datum = textdatum / 3;  // 0=Top, 1=Middle, 2=Bottom
+  if (v_datum == 0) {
+    // Top datum - adjust so y is at top of text
+    if (gfxFont) {
+      adjusted_y += ascent;  // Move down by ascent
+    }
+    // Built-in font: no adjustment needed (draws from top)
+  } else if (v_datum == 1) {
+    // Middle datum - adjust so y is at vertical center
+    if (gfxFont) {
+      adjusted_y += ascent - (height / 2);
+    } else {
+      adjusted_y += height / 2;
+    }
+  }
+  // Bottom/Baseline datum (v_datum == 2): no adjustment (default GFX behavior)
+  
+  // Set position
+  cursor_x = adjusted_x;
+  cursor_y = adjusted_y;
+  
+  // Draw the string using existing print method
+  print(string.c_str());
+  
+  // Restore original cursor position, size, and font
+  cursor_x = old_x;
+  cursor_y = old_y;
+  textsize = old_size;
+  gfxFont = old_font;
+  
+  return width;
+}
+
+// Draw string centered horizontally around x coordinate
+template <class Target>
+int16_t ILI9486_GFX<Target>::drawCentreString(const char *string, int32_t x, int32_t y, uint8_t font) {
+  // Save current state
+  uint8_t old_size = textsize;
+  const GFXfont *old_font = gfxFont;
+  
+  // Font selection logic (same as drawString)
+  if (font == 0) {
+    // Use current font from setFreeFont()
+    textsize = old_size;
+  } else if (font == 1) {
+    // Explicitly select built-in 5x7 font
+    gfxFont = nullptr;
+    textsize = old_size;
+  } else if (font < 6) {
+    // Select from font array (indices 2-5)
+    if (fontArray[font] != nullptr) {
+      gfxFont = fontArray[font];
+      textsize = old_size;
+    } else {
+      // Font slot empty, fall back to built-in 5x7
+      gfxFont = nullptr;
+      textsize = old_size;
+    }
+  } else {
+    // Out of bounds, fall back to built-in 5x7
+    gfxFont = nullptr;
+    textsize = old_size;
+  }
+  
+  // Calculate width to determine center offset
+  int16_t width = 0;
+  
+  if (gfxFont) {
+    // GFX font - sum character advances
+    const char *p = string;
+    while (*p) {
+      char c = *p++;
+      if (c >= gfxFont->first && c <= gfxFont->last) {
+        uint8_t glyph_index = c - gfxFont->first;
+        GFXglyph *glyph = &(((GFXglyph *)gfxFont->glyph)[glyph_index]);
+        width += pgm_read_byte(&glyph->xAdvance) * textsize;
+      }
+    }
+  } else {
+    // Built-in font - 6 pixels per char (5 + 1 spacing)
+    width = strlen(string) * 6 * textsize;
+  }
+  
+  // Restore font and textsize
+  gfxFont = old_font;
+  textsize = old_size;
+  
+  // Draw centered by offsetting x by half the width
+  return drawString(String(string), x - (width / 2), y, font);
+}
+
+// Draw bitmap (1-bit per pixel, MSB first)
+template <class Target>
+void ILI9486_GFX<Target>::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color) {
+  int16_t byteWidth = (w + 7) / 8;
+  uint8_t byte = 0;
+  
+  // Set pixels are drawn as horizontal runs
+  self().startWrite();
+  for (int16_t j = 0; j < h; j++) {
+    int16_t runStart = -1;
+    for (int16_t i = 0; i < w; i++) {
+      if (i & 7) {
+        byte <<= 1;
+      } else {
+        byte = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
+      }
+      if (byte & 0x80) {
+        if (runStart < 0) runStart = i;
+      } else if (runStart >= 0) {
+        self().fillRect(x + runStart, y + j, i - runStart, 1, color);
+        runStart = -1;
+      }
+    }
+    if (runStart >= 0) {
+      self().fillRect(x + runStart, y + j, w - runStart, 1, color);
+    }
+  }
+  self().endWrite();
+}
+
+// Draw bitmap with background color
+template <class Target>
+void ILI9486_GFX<Target>::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg) {
+  int16_t byteWidth = (w + 7) / 8;
+  uint8_t fhi = color >> 8, flo = color & 0xFF;
+  uint8_t bhi = bg >> 8, blo = bg & 0xFF;
+  
+  // Expanded band by band through the line buffers, one window for the bitmap
+  self().pushRows(x, y, w, h,
+    [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+      const uint8_t *src = &bitmap[row * byteWidth];
+      for (uint16_t i = 0; i < count; i++) {
+        uint16_t b = col + i;
+        bool on = pgm_read_byte(&src[b >> 3]) & (0x80 >> (b & 7));
+        *dst++ = on ? fhi : bhi;
+        *dst++ = on ? flo : blo;
+      }
+    });
+}
+
+// Image push through the target's row sink
+template <class Target>
+void ILI9486_GFX<Target>::pushImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *data) {
+  if (x >= self().width() || y >= self().height() || x + w > self().width()) return;
+  if (y + h > self().height()) h = self().height() - y;
+  if (w == 0 || h == 0) return;
+  
+  self().pushRows(x, y, w, h, [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+    memcpy(dst, &data[(uint32_t)row * w + col], count * 2);
+  });
+}
+
+// Dirty-rectangle merging: the cost of sending one more window (CASET/RASET/
+// RAMWR setup and transfer latency), in pixels. Two dirty areas are merged
+// when the pixels wasted by their bounding box cost less than this.
+#ifndef ILI9486_DIRTY_WINDOW_COST
+#define ILI9486_DIRTY_WINDOW_COST 64
+#endif
+
+// Add an area (inclusive bounds x0, y0, x1, y1) to a set of at most maxRects.
+// It is folded into every existing area for which one bounding window costs
+// less than two windows, then kept as a new area; when the set is full it
+// goes into the area where merging wastes least. Used for the canvas dirty
+// set and the scene damage set.
+template <class Rect>
+void ili9486_merge_rect(Rect *rects, uint8_t &count, uint8_t maxRects, Rect r) {
+  int8_t best = -1;
+  int32_t bestCost = 0;
+  for (int8_t i = 0; i < count; i++) {
+    const Rect &d = rects[i];
+    Rect u = d;
+    if (r.x0 < u.x0) u.x0 = r.x0;
+    if (r.y0 < u.y0) u.y0 = r.y0;
+    if (r.x1 > u.x1) u.x1 = r.x1;
+    if (r.y1 > u.y1) u.y1 = r.y1;
+    int32_t cost = (int32_t)(u.x1 - u.x0 + 1) * (u.y1 - u.y0 + 1)
+                 - (int32_t)(d.x1 - d.x0 + 1) * (d.y1 - d.y0 + 1)
+                 - (int32_t)(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1)
+                 - ILI9486_DIRTY_WINDOW_COST;
+    if (cost <= 0) {
+      // Worth merging: take the area out and keep growing r
+      r = u;
+      rects[i] = rects[--count];
+      i = -1;
+      best = -1;
+      continue;
+    }
+    if (best < 0 || cost < bestCost) {
+      best = i;
+      bestCost = cost;
+    }
+  }
+  
+  if (count < maxRects) {
+    rects[count++] = r;
+  } else {
+    Rect &d = rects[best];
+    if (r.x0 < d.x0) d.x0 = r.x0;
+    if (r.y0 < d.y0) d.y0 = r.y0;
+    if (r.x1 > d.x1) d.x1 = r.x1;
+    if (r.y1 > d.y1) d.y1 = r.y1;
+  }
+}
+
+// Areas of a surface changed since they were last sent (inclusive bounds),
+// kept small by ili9486_merge_rect(). An ILI9486_RamCanvas adds whatever it
+// draws to one (see trackDirty()).
+struct ILI9486_DirtyRect {
+  uint16_t x0, y0, x1, y1;
+};
+
+class ILI9486_DirtySet {
+public:
+  static const uint8_t MAX_RECTS = 16;
+  
+  ILI9486_DirtySet() : _count(0) {}
+  
+  void add(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    if (w == 0 || h == 0) return;
+    ILI9486_DirtyRect r = { x, y, (uint16_t)(x + w - 1), (uint16_t)(y + h - 1) };
+    ili9486_merge_rect(_rects, _count, MAX_RECTS, r);
+  }
+  void clear() { _count = 0; }
+  uint8_t count() const { return _count; }
+  const ILI9486_DirtyRect &operator[](uint8_t i) const { return _rects[i]; }
+  
+private:
+  ILI9486_DirtyRect _rects[MAX_RECTS];
+  uint8_t _count;
+};
+
+// Drawing target over a caller-owned buffer, RGB565 in panel byte order, so
+// whatever is drawn into it can be sent as is. The buffer may hold only a
+// band of the surface: rows y0 .. y0 + rows - 1 of a width x height area, or
+// more generally a cols x rows window at (x0, y0). Everything is clipped to
+// the surface, then to the window and to the clip rectangle, so the same
+// draw calls can be replayed band by band (see ILI9486_Driver::renderList())
+// or region by region (see ILI9486_Scene).
+//
+//   static uint8_t strip[480 * 40 * 2];
+//   ILI9486_RamCanvas band;
+//   band.setBuffer(strip, 480, 320, 40, 40);   // Rows 40..79 of 480 x 320
+//   band.fillScreen(TFT_BLACK);
+//   band.fillCircle(240, 60, 30, TFT_RED);
+//
+// After setDepth(1, 2, 4 or 8, palette) the buffer holds palette indices
+// instead, most significant bits first, each row padded to a whole byte.
+// Colors are drawn as the nearest palette entry (at 1 bpp: entry 0 for its
+// own color, entry 1 for any other) and readRow() expands them again.
+// ILI9486_Sprite and the driver's full-frame canvas are built on this.
+class ILI9486_RamCanvas : public ILI9486_GFX<ILI9486_RamCanvas> {
+public:
+  ILI9486_RamCanvas() : _buf(nullptr), _width(0), _height(0), _x0(0), _y0(0), _cols(0), _rows(0), _stride(0),
+                        _bpp(16), _palette(nullptr), _indexValid(false), _dirty(nullptr) {
+    clearClip();
+    setWindow(0, 0, 0, 0);
+  }
+  
+  void setBuffer(uint8_t *buf, uint16_t width, uint16_t height, uint16_t y0 = 0, uint16_t rows = 0xFFFF) {
+    setBuffer(buf, width, height, 0, y0, width, rows);
+  }
+  void setBuffer(uint8_t *buf, uint16_t width, uint16_t height, uint16_t x0, uint16_t y0, uint16_t cols, uint16_t rows) {
+    _buf = buf;
+    _width = width;
+    _height = height;
+    _x0 = x0 < width ? x0 : width;
+    _y0 = y0 < height ? y0 : height;
+    _cols = cols < width - _x0 ? cols : width - _x0;
+    _rows = rows < height - _y0 ? rows : height - _y0;
+    _stride = ((uint32_t)_cols * _bpp + 7) / 8;
+    clip();
+  }
+  uint8_t *buffer() { return _buf; }
+  uint32_t stride() { return _stride; }   // Bytes per buffer row
+  
+  // Pixel format of the buffer: 16 (RGB565, the default) or 1, 2, 4 or 8
+  // bits of palette index, with a palette of 1 << bpp entries that the
+  // caller keeps valid. Call paletteChanged() after editing the palette.
+  // Returns false for other depths, or without a palette.
+  bool setDepth(uint8_t bpp, const uint16_t *palette = nullptr) {
+    if (bpp != 16 && ((bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8) || !palette)) return false;
+    _bpp = bpp;
+    _palette = bpp < 16 ? palette : nullptr;
+    _stride = ((uint32_t)_cols * _bpp + 7) / 8;
+    _indexValid = false;
+    return true;
+  }
+  uint8_t depth() { return _bpp; }
+  void paletteChanged() { _indexValid = false; }
+  
+  // Add every area drawn from now on to a dirty set (nullptr to stop)
+  void trackDirty(ILI9486_DirtySet *dirty) { _dirty = dirty; }
+  
+  // Restrict drawing further, in surface coordinates
+  void setClip(int16_t x, int16_t y, int16_t w, int16_t h) {
+    _clipX0 = x;
+    _clipY0 = y;
+    _clipX1 = (int32_t)x + w;
+    _clipY1 = (int32_t)y + h;
+    clip();
+  }
+  void clearClip() { setClip(0, 0, 0x7FFF, 0x7FFF); }
+  
+  uint16_t width() { return _width; }
+  uint16_t height() { return _height; }
+  
+  // Nothing to claim: the buffer is plain memory
+  void startWrite() {}
+  void endWrite() {}
+  
+  void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+  
+  void drawPixel(uint16_t x, uint16_t y, uint16_t color) {
+    if (x < _cx0 || x >= _cx1 || y < _cy0 || y >= _cy1) return;
+    if (_bpp < 16) {
+      put(x, y, index(color));
+    } else {
+      uint8_t *dst = pixel(x, y);
+      dst[0] = color >> 8;
+      dst[1] = color & 0xFF;
+    }
+    if (_dirty) _dirty->add(x, y, 1, 1);
+  }
+  
+  template <class RowFn>
+  void pushRows(int16_t x, int16_t y, int16_t w, int16_t h, RowFn renderRow);
+  
+  // Low-level pixel streaming, as on the driver: setWindow() selects an area
+  // (inclusive corners), pushBlock()/pushPixels() fill it left to right, top
+  // to bottom. Pixels outside the window of the buffer or the clip are skipped.
+  void setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+  void pushBlock(uint16_t color, uint32_t len) {
+    while (len--) stream(color);
+  }
+  void pushPixels(const uint16_t *data, uint32_t len, bool swapBytes = true);  // swapBytes = false: data already in panel byte order
+  
+  // Read back RGB565 (0 outside the buffer). readRow() writes count pixels
+  // of row y from column x, all inside the buffer, in panel byte order - the
+  // arguments of a pushRows() renderer, for sending the buffer on.
+  uint16_t readPixel(uint16_t x, uint16_t y);
+  void readRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *data);
+  void readRow(uint8_t *dst, uint16_t y, uint16_t x, uint16_t count);
+  
+private:
+  uint8_t *_buf;
+  uint16_t _width, _height;
+  uint16_t _x0, _y0, _cols, _rows;      // Window held by the buffer
+  uint32_t _stride;
+  int32_t _clipX0, _clipY0, _clipX1, _clipY1;
+  uint16_t _cx0, _cy0, _cx1, _cy1;      // Window and clip combined (end exclusive)
+  uint8_t _bpp;
+  const uint16_t *_palette;
+  uint16_t _indexColor;                 // Last color looked up in the palette
+  uint8_t _indexValue;
+  bool _indexValid;
+  ILI9486_DirtySet *_dirty;
+  uint16_t _winX0, _winY0, _winX1, _winY1;  // setWindow() area
+  uint16_t _curX, _curY;                // Stream position
+  
+  void clip() {
+    _cx0 = _clipX0 > _x0 ? _clipX0 : _x0;
+    _cy0 = _clipY0 > _y0 ? _clipY0 : _y0;
+    _cx1 = _clipX1 < _x0 + _cols ? (_clipX1 > _cx0 ? _clipX1 : _cx0) : _x0 + _cols;
+    _cy1 = _clipY1 < _y0 + _rows ? (_clipY1 > _cy0 ? _clipY1 : _cy0) : _y0 + _rows;
+  }
+  
+  uint8_t *pixel(uint16_t x, uint16_t y) {
+    return _buf + (uint32_t)(y - _y0) * _stride + (uint32_t)(x - _x0) * 2;
+  }
+  
+  void put(uint16_t x, uint16_t y, uint8_t index) {
+    uint32_t bit = (uint32_t)(x - _x0) * _bpp;
+    uint8_t shift = 8 - _bpp - (bit & 7);
+    uint8_t mask = ((1 << _bpp) - 1) << shift;
+    uint8_t *p = _buf + (uint32_t)(y - _y0) * _stride + (bit >> 3);
+    *p = (*p & ~mask) | ((index << shift) & mask);
+  }
+  
+  uint8_t index(uint16_t color);
+  void span(uint16_t x, uint16_t y, uint16_t w, uint8_t index);
+  
+  void stream(uint16_t color) {
+    if (_curX >= _cx0 && _curX < _cx1 && _curY >= _cy0 && _curY < _cy1) {
+      if (_bpp < 16) {
+        put(_curX, _curY, index(color));
+      } else {
+        uint8_t *dst = pixel(_curX, _curY);
+        dst[0] = color >> 8;
+        dst[1] = color & 0xFF;
+      }
+    }
+    if (++_curX > _winX1) {
+      _curX = _winX0;
+      if (++_curY > _winY1) _curY = _winY0;
+    }
+  }
+};
+
+inline void ILI9486_RamCanvas::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+  if (x >= _width || y >= _height) return;
+  if (x + w > _width) w = _width - x;
+  if (y + h > _height) h = _height - y;
+  uint16_t x0 = x > _cx0 ? x : _cx0;
+  uint16_t x1 = x + w < _cx1 ? x + w : _cx1;
+  uint16_t y0 = y > _cy0 ? y : _cy0;
+  uint16_t y1 = y + h < _cy1 ? y + h : _cy1;
+  if (x0 >= x1 || y0 >= y1) return;
+  if (_bpp < 16) {
+    uint8_t i = index(color);
+    for (uint16_t yy = y0; yy < y1; yy++) {
+      span(x0, yy, x1 - x0, i);
+    }
+  } else {
+    for (uint16_t yy = y0; yy < y1; yy++) {
+      uint8_t *dst = pixel(x0, yy);
+      for (uint16_t i = x0; i < x1; i++) {
+        *dst++ = color >> 8;
+        *dst++ = color & 0xFF;
+      }
+    }
+  }
+  if (_dirty) _dirty->add(x0, y0, x1 - x0, y1 - y0);
+}
+
+// Render the parts of the block rows that fall inside the clip straight into
+// the buffer; into an indexed buffer a chunk at a time, then mapped to the
+// palette
+template <class RowFn>
+void ILI9486_RamCanvas::pushRows(int16_t x, int16_t y, int16_t w, int16_t h, RowFn renderRow) {
+  int32_t x0 = x > (int32_t)_cx0 ? x : _cx0;
+  int32_t x1 = (int32_t)x + w < _cx1 ? (int32_t)x + w : _cx1;
+  int32_t y0 = y > (int32_t)_cy0 ? y : _cy0;
+  int32_t y1 = (int32_t)y + h < _cy1 ? (int32_t)y + h : _cy1;
+  if (x0 >= x1 || y0 >= y1) return;
+  if (_bpp < 16) {
+    uint8_t chunk[128];
+    const int32_t most = sizeof(chunk) / 2;
+    for (int32_t yy = y0; yy < y1; yy++) {
+      for (int32_t c = x0; c < x1; c += most) {
+        int32_t n = x1 - c < most ? x1 - c : most;
+        renderRow(chunk, yy - y, c - x, n);
+        for (int32_t i = 0; i < n; i++) {
+          put(c + i, yy, index((chunk[2 * i] << 8) | chunk[2 * i + 1]));
+        }
+      }
+    }
+  } else {
+    for (int32_t yy = y0; yy < y1; yy++) {
+      renderRow(pixel(x0, yy), yy - y, x0 - x, x1 - x0);
+    }
+  }
+  if (_dirty) _dirty->add(x0, y0, x1 - x0, y1 - y0);
+}
+
+// Palette entry for a color: an exact match, else the nearest one (red and
+// blue are doubled to weigh like the 6-bit green). At 1 bpp only the
+// background (entry 0) clears a pixel, so any other color shows up. The last
+// answer is kept, since consecutive pixels are usually drawn in the same color.
+inline uint8_t ILI9486_RamCanvas::index(uint16_t color) {
+  if (_bpp == 1) return color != _palette[0];
+  if (_indexValid && color == _indexColor) return _indexValue;
+  uint16_t entries = 1 << _bpp;
+  uint8_t best = 0;
+  uint32_t bestDist = 0xFFFFFFFF;
+  for (uint16_t i = 0; i < entries && bestDist > 0; i++) {
+    uint16_t p = _palette[i];
+    int32_t dr = ((int32_t)(p >> 11) - (color >> 11)) * 2;
+    int32_t dg = (int32_t)((p >> 5) & 0x3F) - ((color >> 5) & 0x3F);
+    int32_t db = ((int32_t)(p & 0x1F) - (color & 0x1F)) * 2;
+    uint32_t dist = dr * dr + dg * dg + db * db;
+    if (dist < bestDist) {
+      bestDist = dist;
+      best = i;
+    }
+  }
+  _indexColor = color;
+  _indexValue = best;
+  _indexValid = true;
+  return best;
+}
+
+// Set w indexed pixels of a row: partial bytes pixel by pixel, whole bytes
+// with memset
+inline void ILI9486_RamCanvas::span(uint16_t x, uint16_t y, uint16_t w, uint8_t index) {
+  uint8_t perByte = 8 / _bpp;
+  while (w > 0 && (x - _x0) % perByte) {
+    put(x++, y, index);
+    w--;
+  }
+  if (w >= perByte) {
+    uint8_t fill = index;
+    for (uint8_t s = _bpp; s < 8; s <<= 1) fill |= fill << s;
+    memset(_buf + (uint32_t)(y - _y0) * _stride + (x - _x0) / perByte, fill, w / perByte);
+    x += w - w % perByte;
+    w %= perByte;
+  }
+  while (w > 0) {
+    put(x++, y, index);
+    w--;
+  }
+}
+
+// Set the area for pushBlock()/pushPixels(); the part of it that can be
+// written counts as drawn
+inline void ILI9486_RamCanvas::setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+  if (x0 > x1) ili9486_swap(x0, x1);
+  if (y0 > y1) ili9486_swap(y0, y1);
+  _winX0 = _curX = x0;
+  _winY0 = _curY = y0;
+  _winX1 = x1;
+  _winY1 = y1;
+  if (_dirty) {
+    uint16_t cx0 = x0 > _cx0 ? x0 : _cx0;
+    uint16_t cy0 = y0 > _cy0 ? y0 : _cy0;
+    uint16_t cx1 = (uint32_t)x1 + 1 < _cx1 ? x1 + 1 : _cx1;
+    uint16_t cy1 = (uint32_t)y1 + 1 < _cy1 ? y1 + 1 : _cy1;
+    if (cx0 < cx1 && cy0 < cy1) _dirty->add(cx0, cy0, cx1 - cx0, cy1 - cy0);
+  }
+}
+
+inline void ILI9486_RamCanvas::pushPixels(const uint16_t *data, uint32_t len, bool swapBytes) {
+  const uint8_t *src = (const uint8_t *)data;
+  for (uint32_t i = 0; i < len; i++) {
+    stream(swapBytes ? data[i] : (uint16_t)((src[2 * i] << 8) | src[2 * i + 1]));
+  }
+}
+
+inline uint16_t ILI9486_RamCanvas::readPixel(uint16_t x, uint16_t y) {
+  uint16_t color = 0;
+  readRect(x, y, 1, 1, &color);
+  return color;
+}
+
+inline void ILI9486_RamCanvas::readRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t *data) {
+  uint8_t px[2];
+  for (uint16_t r = 0; r < h; r++) {
+    for (uint16_t c = 0; c < w; c++) {
+      uint16_t xx = x + c, yy = y + r;
+      uint16_t color = 0;
+      if (_buf && xx >= _x0 && xx < _x0 + _cols && yy >= _y0 && yy < _y0 + _rows) {
+        readRow(px, yy, xx, 1);
+        color = (px[0] << 8) | px[1];
+      }
+      *data++ = color;
+    }
+  }
+}
+
+// Pixels of a row in panel byte order, expanding palette indices; whole
+// bytes at a time at 1 bpp (the mono canvas)
+inline void ILI9486_RamCanvas::readRow(uint8_t *dst, uint16_t y, uint16_t x, uint16_t count) {
+  if (_bpp == 16) {
+    memcpy(dst, pixel(x, y), count * 2);
+    return;
+  }
+  const uint8_t *src = _buf + (uint32_t)(y - _y0) * _stride;
+  uint8_t mask = (1 << _bpp) - 1;
+  uint32_t bit = (uint32_t)(x - _x0) * _bpp;
+  if (_bpp == 1) {
+    uint8_t fhi = _palette[1] >> 8, flo = _palette[1] & 0xFF;
+    uint8_t bhi = _palette[0] >> 8, blo = _palette[0] & 0xFF;
+    const uint8_t *p = src + (bit >> 3);
+    uint8_t bits = *p++ << (bit & 7);
+    uint8_t left = 8 - (bit & 7);
+    while (count--) {
+      if (left == 0) {
+        bits = *p++;
+        left = 8;
+      }
+      bool on = bits & 0x80;
+      *dst++ = on ? fhi : bhi;
+      *dst++ = on ? flo : blo;
+      bits <<= 1;
+      left--;
+    }
+    return;
+  }
+  for (uint16_t i = 0; i < count; i++, bit += _bpp) {
+    uint16_t color = _palette[(src[bit >> 3] >> (8 - _bpp - (bit & 7))) & mask];
+    *dst++ = color >> 8;
+    *dst++ = color & 0xFF;
+  }
+}
+
+#endif // ILI9486_GFX_H
@@ -0,0 +1,268 @@
+#ifndef ILI9486_HOSTBUS_H
+#define ILI9486_HOSTBUS_H
+
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+#include "ILI9486_Bus.h"
+
+// In-memory transport for building and benchmarking the drawing code on a
+// desktop machine. Instead of driving wires it records the command/data
+// byte stream the panel would have received, together with counters that
+// make protocol overhead visible.
+//
+// Build on Linux with the stub headers in extras/host, e.g.
+//   g++ -std=gnu++17 -Iextras/host -Isrc my_bench.cpp
+//
+//   ILI9486_Driver<ILI9486_HostBus> tft((ILI9486_HostBus()));
+//   tft.begin();
+//   tft.bus().clear();
+//   tft.drawString("Hello", 10, 10, 1);
+//   printf("%u bytes\n", tft.bus().stats().totalBytes());
+//
+// Queued (asynchronous) writes are modelled on a simulated clock: the host
+// CPU timeline advances only through blocking bus work and advanceMicros(),
+// while queued data drains at the configured SPI rate in the background.
+// That makes CPU/bus overlap measurable:
+//
+//   ILI9486_Fence f = tft.fillRectDMA(0, 0, 320, 480, TFT_BLUE);
+//   tft.bus().advanceMicros(20000);     // 20 ms of CPU work meanwhile
+//   tft.waitDMA(f);
+//   printf("stalled %u us\n", tft.bus().stats().stallMicros());
+//
+// Queued writes are split into transactions the way ILI9486_DMABus splits
+// them, and only QUEUE_DEPTH of those are on the wire at a time. Like the
+// DMA transport's completion task, the model tops the queue up as each one
+// finishes; setPolledRefill(true) instead tops it up only when the driver
+// calls into the bus, which shows what a transport without a completion
+// path would do to long transfers.
+class ILI9486_HostBus {
+public:
+  static const uint8_t QUEUE_DEPTH = 6;  // Transactions in flight
+  static const uint8_t JOB_DEPTH = 8;    // Queued writes waiting for a slot
+
+  struct Stats {
+    uint32_t commands;      // Command bytes (DC low)
+    uint32_t dataBytes;     // Data bytes (DC high), including pixel data
+    uint32_t transactions;  // beginTransaction() calls, i.e. CS assertions
+    uint32_t queued;        // Asynchronous writes queued
+    uint64_t stallNs;       // Simulated time the CPU spent waiting for queued data
+    uint32_t totalBytes() const { return commands + dataBytes; }
+    uint32_t stallMicros() const { return (uint32_t)(stallNs / 1000); }
+  };
+
+  ILI9486_HostBus() : _freq(27000000), _capture(true), _polledRefill(false), _inTransaction(false), _releasePending(false), _fenceIssued(0) { clear(); }
+
+  void begin(uint32_t freq) { _freq = freq; }
+  void hardwareReset() {}
+
+  // Like the DMA transport, a transaction ended while data is still queued
+  // stays open until that data is sent, and is reused if a new one starts
+  void beginTransaction() {
+    retire();
+    if (_releasePending) {
+      _releasePending = false;
+      return;
+    }
+    _inTransaction = true;
+    _stats.transactions++;
+  }
+
+  void endTransaction() {
+    _releasePending = true;
+    retire();
+  }
+
+  void writeCommand(uint8_t cmd) {
+    blockingWrite(1);
+    _stats.commands++;
+    if (_capture) {
+      _commandOffsets.push_back(_bytes.size());
+      _bytes.push_back(cmd);
+    }
+  }
+
+  void write(uint8_t data) {
+    blockingWrite(1);
+    _stats.dataBytes++;
+    if (_capture) _bytes.push_back(data);
+  }
+
+  void write16(uint16_t data) {
+    write(data >> 8);
+    write(data & 0xFF);
+  }
+
+  void writeBytes(const uint8_t *data, uint32_t len) {
+    blockingWrite(len);
+    record(data, len);
+  }
+
+  void writePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total) {
+    blockingWrite(total);
+    recordPattern(buf, bufLen, total);
+  }
+
+  ILI9486_Fence queueBytes(const uint8_t *data, uint32_t len) {
+    record(data, len);
+    return enqueue(len, len);
+  }
+
+  ILI9486_Fence queuePattern(const uint8_t *buf, uint32_t bufLen, uint32_t total) {
+    recordPattern(buf, bufLen, total);
+    return enqueue(bufLen, total);
+  }
+
+  bool fenceDone(ILI9486_Fence fence) {
+    retire();
+    return fence <= _fenceDone;
+  }
+
+  // Stall until the oldest transaction on the wire finishes, then look again
+  void waitFence(ILI9486_Fence fence) {
+    while (!fenceDone(fence)) {
+      stallUntil(_inFlight.front().doneNs);
+    }
+  }
+
+  bool busy() { return !fenceDone(_fenceIssued); }
+  void waitIdle() { waitFence(_fenceIssued); }
+
+  // Simulated CPU time spent on other work
+  void advanceMicros(uint32_t us) { _nowNs += (uint64_t)us * 1000; }
+  uint32_t nowMicros() const { return (uint32_t)(_nowNs / 1000); }
+
+  // Recorded stream. commandOffsets() lists the positions in bytes() that
+  // were sent with DC low; everything else is data.
+  const std::vector<uint8_t> &bytes() const { return _bytes; }
+  const std::vector<uint32_t> &commandOffsets() const { return _commandOffsets; }
+  const Stats &stats() const { return _stats; }
+  bool inTransaction() {
+    retire();
+    return _inTransaction;
+  }
+
+  // Keep counting but stop storing bytes (for large benchmarks)
+  void setCapture(bool capture) { _capture = capture; }
+
+  // Top the transaction queue up only when the driver calls into the bus
+  void setPolledRefill(bool polled) { _polledRefill = polled; }
+
+  // Wire time of everything recorded so far at the configured SPI clock
+  uint32_t busMicros() const { return (uint32_t)((uint64_t)_stats.totalBytes() * 8 * 1000000 / _freq); }
+
+  void clear() {
+    _bytes.clear();
+    _commandOffsets.clear();
+    _jobs.clear();
+    _inFlight.clear();
+    _stats.commands = 0;
+    _stats.dataBytes = 0;
+    _stats.transactions = 0;
+    _stats.queued = 0;
+    _stats.stallNs = 0;
+    _nowNs = 0;
+    _wireEndNs = 0;
+    _fenceDone = _fenceIssued;  // Anything still queued counts as sent
+  }
+
+private:
+  struct Job {
+    uint32_t chunk;         // Bytes per transaction (pattern length)
+    uint32_t remaining;     // Bytes not yet handed to the hardware queue
+    ILI9486_Fence fence;
+  };
+  struct Transfer {
+    ILI9486_Fence fence;    // Set on the last transaction of a write
+    uint64_t doneNs;
+  };
+
+  uint32_t _freq;
+  bool _capture;
+  bool _polledRefill;
+  bool _inTransaction;
+  bool _releasePending;     // endTransaction() came while data was queued
+  Stats _stats;
+  std::vector<uint8_t> _bytes;
+  std::vector<uint32_t> _commandOffsets;
+  std::deque<Job> _jobs;
+  std::deque<Transfer> _inFlight;
+  uint64_t _nowNs;          // Simulated CPU time
+  uint64_t _wireEndNs;      // When the last transaction on the wire finishes
+  ILI9486_Fence _fenceIssued, _fenceDone;
+
+  uint64_t wireNs(uint32_t bytes) const { return (uint64_t)bytes * 8 * 1000000000ULL / _freq; }
+
+  void stallUntil(uint64_t t) {
+    if (t > _nowNs) {
+      _stats.stallNs += t - _nowNs;
+      _nowNs = t;
+    }
+  }
+
+  // Blocking writes wait for queued data, then occupy the CPU for their wire time
+  void blockingWrite(uint32_t bytes) {
+    waitIdle();
+    _nowNs += wireNs(bytes);
+  }
+
+  // A full job list makes the caller wait for the wire, as on the DMA bus
+  ILI9486_Fence enqueue(uint32_t chunk, uint32_t total) {
+    if (total == 0) return _fenceDone;
+    retire();
+    while (_jobs.size() == JOB_DEPTH) {
+      stallUntil(_inFlight.front().doneNs);
+      retire();
+    }
+    Job job = { chunk, total, ++_fenceIssued };
+    _jobs.push_back(job);
+    _stats.queued++;
+    refill(_nowNs);
+    return job.fence;
+  }
+
+  // Retire transactions finished by now. Without polled refill each one is
+  // replaced as it finishes, as the completion task does.
+  void retire() {
+    while (!_inFlight.empty() && _inFlight.front().doneNs <= _nowNs) {
+      Transfer t = _inFlight.front();
+      _inFlight.pop_front();
+      if (t.fence) _fenceDone = t.fence;
+      if (!_polledRefill) refill(t.doneNs);
+    }
+    refill(_nowNs);
+    if (_releasePending && _inFlight.empty()) {
+      _releasePending = false;
+      _inTransaction = false;
+    }
+  }
+
+  // Hand transactions to the hardware queue at time "at"
+  void refill(uint64_t at) {
+    while (_inFlight.size() < QUEUE_DEPTH && !_jobs.empty()) {
+      Job &job = _jobs.front();
+      uint32_t len = job.chunk < job.remaining ? job.chunk : job.remaining;
+      if (len > ILI9486_DMA_MAX_TRANSFER) len = ILI9486_DMA_MAX_TRANSFER;
+      _wireEndNs = (_wireEndNs > at ? _wireEndNs : at) + wireNs(len);
+      job.remaining -= len;
+      Transfer t = { job.remaining == 0 ? job.fence : 0, _wireEndNs };
+      _inFlight.push_back(t);
+      if (job.remaining == 0) _jobs.pop_front();
+    }
+  }
+
+  void record(const uint8_t *data, uint32_t len) {
+    _stats.dataBytes += len;
+    if (_capture) _bytes.insert(_bytes.end(), data, data + len);
+  }
+
+  void recordPattern(const uint8_t *buf, uint32_t bufLen, uint32_t total) {
+    while (total > 0) {
+      uint32_t chunk = total < bufLen ? total : bufLen;
+      record(buf, chunk);
+      total -= chunk;
+    }
+  }
+};
+
+#endif // ILI9486_HOSTBUS_H
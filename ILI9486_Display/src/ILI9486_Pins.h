@@ -0,0 +1,89 @@
+#ifndef ILI9486_PINS_H
+#define ILI9486_PINS_H
+
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#endif
+
+// Pin control policies for ILI9486_Driver.
+//
+// A policy provides begin(), csLow()/csHigh(), dcCommand()/dcData() and
+// rstLow()/rstHigh(). The driver calls these on every command and data
+// write, so they must be cheap.
+
+// Runtime pins - chosen in the constructor, toggled through digitalWrite()
+class ILI9486_RuntimePins {
+public:
+  ILI9486_RuntimePins(int8_t cs, int8_t dc, int8_t rst) : _cs(cs), _dc(dc), _rst(rst) {}
+
+  void begin() {
+    pinMode(_cs, OUTPUT);
+    pinMode(_dc, OUTPUT);
+    if (_rst >= 0) pinMode(_rst, OUTPUT);
+    digitalWrite(_cs, HIGH);
+    digitalWrite(_dc, HIGH);
+  }
+
+  inline void csLow()     { digitalWrite(_cs, LOW); }
+  inline void csHigh()    { digitalWrite(_cs, HIGH); }
+  inline void dcCommand() { digitalWrite(_dc, LOW); }
+  inline void dcData()    { digitalWrite(_dc, HIGH); }
+  inline void rstLow()    { if (_rst >= 0) digitalWrite(_rst, LOW); }
+  inline void rstHigh()   { if (_rst >= 0) digitalWrite(_rst, HIGH); }
+
+private:
+  int8_t _cs, _dc, _rst;
+};
+
+// Compile-time pins - every toggle is a single GPIO set/clear register write.
+// Use a negative pin number for a signal that is not connected (e.g. RST tied high).
+template <int8_t CS, int8_t DC, int8_t RST = -1>
+class ILI9486_StaticPins {
+public:
+  static void begin() {
+    pinMode(CS, OUTPUT);
+    pinMode(DC, OUTPUT);
+    if (RST >= 0) pinMode(RST, OUTPUT);
+    csHigh();
+    dcData();
+  }
+
+  static inline void csLow()     { clear<CS>(); }
+  static inline void csHigh()    { set<CS>(); }
+  static inline void dcCommand() { clear<DC>(); }
+  static inline void dcData()    { set<DC>(); }
+  static inline void rstLow()    { clear<RST>(); }
+  static inline void rstHigh()   { set<RST>(); }
+
+private:
+  template <int8_t PIN>
+  static inline void set() {
+    if (PIN < 0) return;
+#if defined(ARDUINO_ARCH_ESP32)
+#if defined(GPIO_OUT1_W1TS_REG)
+    if (PIN >= 32) { REG_WRITE(GPIO_OUT1_W1TS_REG, 1UL << (PIN & 31)); return; }
+#endif
+    REG_WRITE(GPIO_OUT_W1TS_REG, 1UL << (PIN & 31));
+#else
+    digitalWrite(PIN, HIGH);
+#endif
+  }
+
+  template <int8_t PIN>
+  static inline void clear() {
+    if (PIN < 0) return;
+#if defined(ARDUINO_ARCH_ESP32)
+#if defined(GPIO_OUT1_W1TC_REG)
+    if (PIN >= 32) { REG_WRITE(GPIO_OUT1_W1TC_REG, 1UL << (PIN & 31)); return; }
+#endif
+    REG_WRITE(GPIO_OUT_W1TC_REG, 1UL << (PIN & 31));
+#else
+    digitalWrite(PIN, LOW);
+#endif
+  }
+};
+
+#endif // ILI9486_PINS_H
@@ -0,0 +1,626 @@
+#ifndef ILI9486_SCENE_H
+#define ILI9486_SCENE_H
+
+#include "ILI9486_Display.h"
+
+// Size of each of the two strips a damaged area is rendered through (bytes).
+// An area is rendered in bands of as many of its rows as fit in a strip.
+#ifndef ILI9486_SCENE_STRIP_BYTES
+#define ILI9486_SCENE_STRIP_BYTES 8192
+#endif
+
+// Retained-mode scene: the screen is described by a set of nodes (filled
+// rectangles, frames, circles, lines, images and text labels) stacked by z
+// order, and the scene redraws it. Changing a node only damages the area it
+// covered and now covers; update() then re-renders just the damaged areas,
+// visiting only the nodes that touch them. Within an area, nothing under an
+// opaque node (filled rectangle, image, label with a background) that covers
+// it is drawn at all.
+//
+// Each damaged area is composed off-screen in a strip, band by band, and sent
+// with one window per band while the next band is rendered, so the panel
+// never shows a half-drawn area.
+//
+//   ILI9486_Scene<ILI9486_Display> scene(tft);
+//   scene.begin(64, TFT_BLUE);
+//   int16_t panel = scene.addRect(20, 20, 200, 120, TFT_DARKGREY);
+//   int16_t temp = scene.addLabel(30, 40, 180, 30, "21.5 C", TFT_WHITE, TFT_DARKGREY, 1);
+//   scene.setFont(temp, &FreeSans12pt7b, 1, MC_DATUM);
+//   scene.update();                     // Draws the whole screen once
+//   ...
+//   scene.setText(temp, "22.0 C");      // Damages the label box only
+//   scene.moveTo(panel, 40, 30);        // Damages the old and new box
+//   scene.update();
+//
+// Text and images are referenced, not copied: keep them valid while the
+// node uses them, and call invalidate() after changing them in place.
+// Display is anything with the driver's drawing-window API: ILI9486_Driver
+// (any bus) or ILI9486_Sprite.
+template <class Display>
+class ILI9486_Scene {
+public:
+  ILI9486_Scene(Display &tft);
+  ~ILI9486_Scene() { end(); }
+  ILI9486_Scene(const ILI9486_Scene &) = delete;
+  ILI9486_Scene &operator=(const ILI9486_Scene &) = delete;
+  
+  // Room for maxNodes nodes, over a background of color bg. The whole
+  // screen starts damaged. Returns false if out of memory.
+  bool begin(uint16_t maxNodes, uint16_t bg = TFT_BLACK);
+  void end();
+  
+  // Add a node on top of those with the same z. Each returns the node id,
+  // or -1 when the scene is full.
+  int16_t addRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, int16_t z = 0);
+  int16_t addFrame(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, int16_t z = 0);
+  int16_t addCircle(int16_t x, int16_t y, int16_t r, uint16_t color, int16_t z = 0);
+  int16_t addDisc(int16_t x, int16_t y, int16_t r, uint16_t color, int16_t z = 0);
+  int16_t addLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, int16_t z = 0);
+  int16_t addImage(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *data, int16_t z = 0);  // Panel byte order
+  
+  // Text in a w x h box, placed by the datum (TL_DATUM by default) and
+  // clipped to the box. A label fills its box with bg; text has no
+  // background of its own.
+  int16_t addLabel(int16_t x, int16_t y, int16_t w, int16_t h, const char *text, uint16_t fg, uint16_t bg, int16_t z = 0);
+  int16_t addText(int16_t x, int16_t y, int16_t w, int16_t h, const char *text, uint16_t fg, int16_t z = 0);
+  
+  // Change a node. Positions are as given when adding it (the centre of a
+  // circle, the first end of a line, which takes the second end along); the
+  // size of a circle is its radius and images keep the size they were added
+  // with.
+  // Each returns false for an unknown id or a change the node does not take.
+  bool moveTo(int16_t id, int16_t x, int16_t y);
+  bool setSize(int16_t id, int16_t w, int16_t h);
+  bool setColor(int16_t id, uint16_t color);
+  bool setBackground(int16_t id, uint16_t bg);
+  bool setText(int16_t id, const char *text);
+  bool setFont(int16_t id, const GFXfont *font, uint8_t size = 1, uint8_t datum = TL_DATUM);
+  bool setImage(int16_t id, const uint16_t *data);
+  bool setZ(int16_t id, int16_t z);   // Also raises it above the others at z
+  bool setVisible(int16_t id, bool visible);
+  bool remove(int16_t id);
+  
+  // Redraw a node whose text or image changed in place, or everything
+  bool invalidate(int16_t id);
+  void invalidateAll();
+  
+  // Redraw the damaged areas. Deferred drawing is flushed first. Returns
+  // false if nothing was damaged, or while a display list is being recorded
+  // (the damage is kept for the next update()).
+  bool update();
+  
+  uint16_t nodeCount() { return _count; }
+  uint16_t nodesDrawn() { return _drawn; }   // Node draws done by the last update()
+  
+private:
+  enum NodeKind : uint8_t {
+    NODE_FREE = 0,
+    NODE_RECT,
+    NODE_FRAME,
+    NODE_CIRCLE,
+    NODE_DISC,
+    NODE_LINE,
+    NODE_IMAGE,
+    NODE_LABEL,
+    NODE_TEXT,
+  };
+  
+  struct Node {
+    NodeKind kind;
+    bool visible;
+    uint8_t textSize;
+    uint8_t datum;
+    int16_t z;
+    int16_t x, y, w, h;     // Lines: w, h is the second end
+    uint16_t color, bg;
+    const void *data;       // Text or image
+    const GFXfont *font;
+  };
+  
+  // Inclusive bounds
+  struct Area {
+    int16_t x0, y0, x1, y1;
+  };
+  
+  // A node touching the area being rendered
+  struct Hit {
+    Area box;
+    uint16_t id;
+    bool opaque;
+  };
+  
+  static const uint8_t DAMAGE_RECTS = 16;
+  
+  Display &_tft;
+  Node *_nodes;
+  uint16_t *_order;         // Node ids, bottom to top
+  Hit *_hits;
+  uint16_t _cap, _count;
+  uint16_t _bg;
+  Area _damage[DAMAGE_RECTS];
+  uint8_t _damageCount;
+  uint8_t *_strip[2];
+  ILI9486_Fence _fence[2];
+  uint16_t _drawn;
+  ILI9486_RamCanvas _canvas;
+  
+  int16_t add(NodeKind kind, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, int16_t z);
+  Node *node(int16_t id) { return id >= 0 && id < _cap && _nodes[id].kind != NODE_FREE ? &_nodes[id] : nullptr; }
+  void link(uint16_t id);
+  void unlink(uint16_t id);
+  
+  static Area bounds(const Node &n);
+  static int16_t clamp16(int32_t v) { return v < -32768 ? -32768 : v > 32767 ? 32767 : v; }
+  static bool opaque(const Node &n) { return n.kind == NODE_RECT || n.kind == NODE_IMAGE || n.kind == NODE_LABEL; }
+  static bool empty(const Area &a) { return a.x0 > a.x1 || a.y0 > a.y1; }
+  static bool covers(const Area &a, const Area &b) { return a.x0 <= b.x0 && a.y0 <= b.y0 && a.x1 >= b.x1 && a.y1 >= b.y1; }
+  static Area intersect(const Area &a, const Area &b);
+  
+  void touch(const Node &n) { if (n.visible) damage(bounds(n)); }
+  void damage(Area a);
+  void renderArea(const Area &area);
+  void renderBand(const Area &band, uint16_t hits);
+  void drawNode(const Node &n, const Area &clip);
+  void fillArea(const Area &a, const Area &clip, uint16_t color);
+};
+
+template <class Display>
+ILI9486_Scene<Display>::ILI9486_Scene(Display &tft)
+  : _tft(tft), _nodes(nullptr), _order(nullptr), _hits(nullptr), _cap(0), _count(0), _bg(TFT_BLACK),
+    _damageCount(0), _drawn(0) {
+  _strip[0] = _strip[1] = nullptr;
+  _fence[0] = _fence[1] = 0;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::begin(uint16_t maxNodes, uint16_t bg) {
+  end();
+  if (maxNodes == 0 || maxNodes > 0x7FFF) return false;
+  _nodes = (Node *)malloc((size_t)maxNodes * sizeof(Node));
+  _order = (uint16_t *)malloc((size_t)maxNodes * sizeof(uint16_t));
+  _hits = (Hit *)malloc((size_t)maxNodes * sizeof(Hit));
+  _strip[0] = (uint8_t *)ili9486_dma_alloc(ILI9486_SCENE_STRIP_BYTES);
+  _strip[1] = (uint8_t *)ili9486_dma_alloc(ILI9486_SCENE_STRIP_BYTES);
+  if (!_nodes || !_order || !_hits || !_strip[0] || !_strip[1]) {
+    end();
+    return false;
+  }
+  for (uint16_t i = 0; i < maxNodes; i++) {
+    _nodes[i].kind = NODE_FREE;
+  }
+  _cap = maxNodes;
+  _bg = bg;
+  invalidateAll();
+  return true;
+}
+
+template <class Display>
+void ILI9486_Scene<Display>::end() {
+  if (_strip[0] || _strip[1]) _tft.waitDMA();
+  ili9486_dma_free(_strip[0]);
+  ili9486_dma_free(_strip[1]);
+  _strip[0] = _strip[1] = nullptr;
+  _fence[0] = _fence[1] = 0;
+  free(_nodes);
+  free(_order);
+  free(_hits);
+  _nodes = nullptr;
+  _order = nullptr;
+  _hits = nullptr;
+  _cap = _count = 0;
+  _damageCount = 0;
+}
+
+template <class Display>
+int16_t ILI9486_Scene<Display>::add(NodeKind kind, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, int16_t z) {
+  if (_count >= _cap) return -1;
+  uint16_t id = 0;
+  while (_nodes[id].kind != NODE_FREE) id++;
+  
+  Node &n = _nodes[id];
+  n.kind = kind;
+  n.visible = true;
+  n.textSize = 1;
+  n.datum = TL_DATUM;
+  n.z = z;
+  n.x = x;
+  n.y = y;
+  n.w = w;
+  n.h = h;
+  n.color = color;
+  n.bg = color;
+  n.data = nullptr;
+  n.font = nullptr;
+  link(id);
+  touch(n);
+  return id;
+}
+
+template <class Display>
+int16_t ILI9486_Scene<Display>::addRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, int16_t z) {
+  return add(NODE_RECT, x, y, w, h, color, z);
+}
+
+template <class Display>
+int16_t ILI9486_Scene<Display>::addFrame(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, int16_t z) {
+  return add(NODE_FRAME, x, y, w, h, color, z);
+}
+
+template <class Display>
+int16_t ILI9486_Scene<Display>::addCircle(int16_t x, int16_t y, int16_t r, uint16_t color, int16_t z) {
+  return add(NODE_CIRCLE, x, y, r, r, color, z);
+}
+
+template <class Display>
+int16_t ILI9486_Scene<Display>::addDisc(int16_t x, int16_t y, int16_t r, uint16_t color, int16_t z) {
+  return add(NODE_DISC, x, y, r, r, color, z);
+}
+
+template <class Display>
+int16_t ILI9486_Scene<Display>::addLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, int16_t z) {
+  return add(NODE_LINE, x0, y0, x1, y1, color, z);
+}
+
+template <class Display>
+int16_t ILI9486_Scene<Display>::addImage(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *data, int16_t z) {
+  if (!data) return -1;
+  int16_t id = add(NODE_IMAGE, x, y, w, h, 0, z);
+  if (id >= 0) _nodes[id].data = data;
+  return id;
+}
+
+template <class Display>
+int16_t ILI9486_Scene<Display>::addLabel(int16_t x, int16_t y, int16_t w, int16_t h, const char *text, uint16_t fg, uint16_t bg, int16_t z) {
+  int16_t id = add(NODE_LABEL, x, y, w, h, fg, z);
+  if (id >= 0) {
+    _nodes[id].bg = bg;
+    _nodes[id].data = text;
+  }
+  return id;
+}
+
+template <class Display>
+int16_t ILI9486_Scene<Display>::addText(int16_t x, int16_t y, int16_t w, int16_t h, const char *text, uint16_t fg, int16_t z) {
+  int16_t id = add(NODE_TEXT, x, y, w, h, fg, z);
+  if (id >= 0) _nodes[id].data = text;
+  return id;
+}
+
+// Put a node into the drawing order, above everything at its z
+template <class Display>
+void ILI9486_Scene<Display>::link(uint16_t id) {
+  int16_t z = _nodes[id].z;
+  uint16_t k = _count;
+  while (k > 0 && _nodes[_order[k - 1]].z > z) {
+    _order[k] = _order[k - 1];
+    k--;
+  }
+  _order[k] = id;
+  _count++;
+}
+
+template <class Display>
+void ILI9486_Scene<Display>::unlink(uint16_t id) {
+  uint16_t k = 0;
+  while (_order[k] != id) k++;
+  memmove(&_order[k], &_order[k + 1], (_count - k - 1) * sizeof(uint16_t));
+  _count--;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::moveTo(int16_t id, int16_t x, int16_t y) {
+  Node *n = node(id);
+  if (!n) return false;
+  if (n->x == x && n->y == y) return true;
+  if (n->kind == NODE_LINE) {
+    // The second end moves along, if it stays in range
+    int32_t x1 = (int32_t)n->w + x - n->x, y1 = (int32_t)n->h + y - n->y;
+    if (x1 != (int16_t)x1 || y1 != (int16_t)y1) return false;
+    touch(*n);
+    n->w = x1;
+    n->h = y1;
+  } else {
+    touch(*n);
+  }
+  n->x = x;
+  n->y = y;
+  touch(*n);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::setSize(int16_t id, int16_t w, int16_t h) {
+  Node *n = node(id);
+  if (!n || n->kind == NODE_LINE || n->kind == NODE_IMAGE) return false;
+  if (n->kind == NODE_CIRCLE || n->kind == NODE_DISC) h = w;
+  touch(*n);
+  n->w = w;
+  n->h = h;
+  touch(*n);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::setColor(int16_t id, uint16_t color) {
+  Node *n = node(id);
+  if (!n || n->kind == NODE_IMAGE) return false;
+  if (n->color == color) return true;
+  n->color = color;
+  touch(*n);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::setBackground(int16_t id, uint16_t bg) {
+  Node *n = node(id);
+  if (!n || n->kind != NODE_LABEL) return false;
+  if (n->bg == bg) return true;
+  n->bg = bg;
+  touch(*n);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::setText(int16_t id, const char *text) {
+  Node *n = node(id);
+  if (!n || (n->kind != NODE_LABEL && n->kind != NODE_TEXT)) return false;
+  n->data = text;
+  touch(*n);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::setFont(int16_t id, const GFXfont *font, uint8_t size, uint8_t datum) {
+  Node *n = node(id);
+  if (!n || (n->kind != NODE_LABEL && n->kind != NODE_TEXT)) return false;
+  n->font = font;
+  n->textSize = size ? size : 1;
+  n->datum = datum;
+  touch(*n);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::setImage(int16_t id, const uint16_t *data) {
+  Node *n = node(id);
+  if (!n || n->kind != NODE_IMAGE || !data) return false;
+  n->data = data;
+  touch(*n);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::setZ(int16_t id, int16_t z) {
+  Node *n = node(id);
+  if (!n) return false;
+  unlink(id);
+  n->z = z;
+  link(id);
+  touch(*n);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::setVisible(int16_t id, bool visible) {
+  Node *n = node(id);
+  if (!n) return false;
+  if (n->visible == visible) return true;
+  n->visible = true;
+  touch(*n);
+  n->visible = visible;
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::remove(int16_t id) {
+  Node *n = node(id);
+  if (!n) return false;
+  touch(*n);
+  unlink(id);
+  n->kind = NODE_FREE;
+  return true;
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::invalidate(int16_t id) {
+  Node *n = node(id);
+  if (!n) return false;
+  touch(*n);
+  return true;
+}
+
+template <class Display>
+void ILI9486_Scene<Display>::invalidateAll() {
+  _damageCount = 0;
+  Area all = { 0, 0, (int16_t)(_tft.width() - 1), (int16_t)(_tft.height() - 1) };
+  damage(all);
+}
+
+// Everything the node can draw on. Edges past the int16_t range are
+// clamped to it, which does not change what is on screen.
+template <class Display>
+typename ILI9486_Scene<Display>::Area ILI9486_Scene<Display>::bounds(const Node &n) {
+  int32_t x0, y0, x1, y1;
+  switch (n.kind) {
+    case NODE_CIRCLE:
+    case NODE_DISC:
+      x0 = n.x - n.w; y0 = n.y - n.w;
+      x1 = n.x + n.w; y1 = n.y + n.w;
+      break;
+    case NODE_LINE:
+      x0 = n.x < n.w ? n.x : n.w; x1 = n.x < n.w ? n.w : n.x;
+      y0 = n.y < n.h ? n.y : n.h; y1 = n.y < n.h ? n.h : n.y;
+      break;
+    default:
+      x0 = n.x; y0 = n.y;
+      x1 = n.x + n.w - 1; y1 = n.y + n.h - 1;
+      break;
+  }
+  Area a = { clamp16(x0), clamp16(y0), clamp16(x1), clamp16(y1) };
+  return a;
+}
+
+template <class Display>
+typename ILI9486_Scene<Display>::Area ILI9486_Scene<Display>::intersect(const Area &a, const Area &b) {
+  Area r = { a.x0 > b.x0 ? a.x0 : b.x0, a.y0 > b.y0 ? a.y0 : b.y0,
+             a.x1 < b.x1 ? a.x1 : b.x1, a.y1 < b.y1 ? a.y1 : b.y1 };
+  return r;
+}
+
+// Add an area to the damage set, merged the way the canvas merges its dirty
+// areas
+template <class Display>
+void ILI9486_Scene<Display>::damage(Area r) {
+  Area screen = { 0, 0, (int16_t)(_tft.width() - 1), (int16_t)(_tft.height() - 1) };
+  r = intersect(r, screen);
+  if (!empty(r)) ili9486_merge_rect(_damage, _damageCount, DAMAGE_RECTS, r);
+}
+
+template <class Display>
+bool ILI9486_Scene<Display>::update() {
+  _drawn = 0;
+  if (!_nodes || _damageCount == 0) return false;
+  // The strips are reused as soon as their transfer is done, so they must
+  // not end up in a list that keeps only the pointer
+  _tft.endDeferred();
+  if (_tft.recording()) return false;
+  _tft.startWrite();
+  for (uint8_t i = 0; i < _damageCount; i++) {
+    renderArea(_damage[i]);
+  }
+  _tft.endWrite();
+  _damageCount = 0;
+  return true;
+}
+
+// Render one damaged area in bands, each sent while the next is rendered
+// into the other strip
+template <class Display>
+void ILI9486_Scene<Display>::renderArea(const Area &area) {
+  // The nodes that touch the area, bottom to top
+  uint16_t hits = 0;
+  for (uint16_t k = 0; k < _count; k++) {
+    const Node &n = _nodes[_order[k]];
+    if (!n.visible) continue;
+    Area box = intersect(bounds(n), area);
+    if (empty(box)) continue;
+    _hits[hits].box = box;
+    _hits[hits].id = _order[k];
+    _hits[hits].opaque = opaque(n);
+    hits++;
+  }
+  
+  uint16_t cols = area.x1 - area.x0 + 1;
+  uint16_t bandRows = ILI9486_SCENE_STRIP_BYTES / ((uint32_t)cols * 2);
+  if (bandRows == 0) bandRows = 1;
+  uint8_t s = 0;
+  for (int32_t y = area.y0; y <= area.y1; y += bandRows) {
+    Area band = { area.x0, (int16_t)y, area.x1, (int16_t)(y + bandRows - 1 < area.y1 ? y + bandRows - 1 : area.y1) };
+    uint16_t rows = band.y1 - band.y0 + 1;
+    _tft.waitDMA(_fence[s]);
+    _canvas.setBuffer(_strip[s], _tft.width(), _tft.height(), band.x0, band.y0, cols, rows);
+    renderBand(band, hits);
+    _fence[s] = _tft.pushImageDMA(band.x0, band.y0, cols, rows, (const uint16_t *)_strip[s]);
+    s ^= 1;
+  }
+}
+
+// Compose a band into the canvas. Drawing starts at the topmost opaque node
+// covering the whole band, and skips any node whose part in the band is
+// covered by an opaque node above it.
+template <class Display>
+void ILI9486_Scene<Display>::renderBand(const Area &band, uint16_t hits) {
+  int32_t first = hits;
+  while (--first >= 0) {
+    if (_hits[first].opaque && covers(_hits[first].box, band)) break;
+  }
+  if (first < 0) {
+    _canvas.fillScreen(_bg);
+    first = 0;
+  }
+  
+  for (uint16_t i = first; i < hits; i++) {
+    Area part = intersect(_hits[i].box, band);
+    if (empty(part)) continue;
+    bool hidden = false;
+    for (uint16_t j = i + 1; j < hits && !hidden; j++) {
+      hidden = _hits[j].opaque && covers(_hits[j].box, part);
+    }
+    if (hidden) continue;
+    drawNode(_nodes[_hits[i].id], part);
+    _drawn++;
+  }
+}
+
+// Fill a (possibly off-screen) area, clipped
+template <class Display>
+void ILI9486_Scene<Display>::fillArea(const Area &a, const Area &clip, uint16_t color) {
+  Area c = intersect(a, clip);
+  if (!empty(c)) _canvas.fillRect(c.x0, c.y0, c.x1 - c.x0 + 1, c.y1 - c.y0 + 1, color);
+}
+
+// Draw a node, clipped to clip (which lies inside both the node bounds and
+// the band)
+template <class Display>
+void ILI9486_Scene<Display>::drawNode(const Node &n, const Area &clip) {
+  Area box = bounds(n);
+  switch (n.kind) {
+    case NODE_RECT:
+      fillArea(box, clip, n.color);
+      return;
+    case NODE_FRAME: {
+      Area top = { box.x0, box.y0, box.x1, box.y0 }, bottom = { box.x0, box.y1, box.x1, box.y1 };
+      Area left = { box.x0, box.y0, box.x0, box.y1 }, right = { box.x1, box.y0, box.x1, box.y1 };
+      fillArea(top, clip, n.color);
+      fillArea(bottom, clip, n.color);
+      fillArea(left, clip, n.color);
+      fillArea(right, clip, n.color);
+      return;
+    }
+    case NODE_IMAGE: {
+      const uint16_t *data = (const uint16_t *)n.data;
+      uint16_t w = n.w;
+      _canvas.setClip(clip.x0, clip.y0, clip.x1 - clip.x0 + 1, clip.y1 - clip.y0 + 1);
+      _canvas.pushRows(n.x, n.y, n.w, n.h, [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+        memcpy(dst, &data[(uint32_t)row * w + col], count * 2);
+      });
+      _canvas.clearClip();
+      return;
+    }
+    default:
+      break;
+  }
+  
+  _canvas.setClip(clip.x0, clip.y0, clip.x1 - clip.x0 + 1, clip.y1 - clip.y0 + 1);
+  switch (n.kind) {
+    case NODE_CIRCLE:
+      _canvas.drawCircle(n.x, n.y, n.w, n.color);
+      break;
+    case NODE_DISC:
+      _canvas.fillCircle(n.x, n.y, n.w, n.color);
+      break;
+    case NODE_LINE:
+      _canvas.drawLine(n.x, n.y, n.w, n.h, n.color);
+      break;
+    case NODE_LABEL:
+    case NODE_TEXT: {
+      if (n.kind == NODE_LABEL) fillArea(box, clip, n.bg);
+      if (!n.data) break;
+      // Anchor the datum names inside the box
+      uint8_t col = n.datum % 3, row = n.datum / 3;
+      int32_t x = col == 0 ? n.x : col == 1 ? n.x + n.w / 2 : n.x + n.w - 1;
+      int32_t y = row == 0 ? n.y : row == 1 ? n.y + n.h / 2 : n.y + n.h - 1;
+      _canvas.setFreeFont(n.font);
+      _canvas.setTextSize(n.textSize);
+      _canvas.setTextDatum(n.datum);
+      _canvas.setTextColor(n.color);
+      _canvas.drawString((const char *)n.data, x, y);
+      break;
+    }
+    default:
+      break;
+  }
+  _canvas.clearClip();
+}
+
+#endif // ILI9486_SCENE_H
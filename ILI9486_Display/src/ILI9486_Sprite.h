@@ -0,0 +1,239 @@
+#ifndef ILI9486_SPRITE_H
+#define ILI9486_SPRITE_H
+
+#include "ILI9486_Display.h"
+
+// Off-screen RGB565 sprite: an ILI9486_RamCanvas that owns its buffer, so
+// every primitive and the whole text API work exactly as on the display.
+// Compose a widget off-screen, then push it with one window and one bulk
+// transfer - no flicker from clearing and redrawing on the panel:
+//
+//   ILI9486_Sprite label;
+//   label.createSprite(120, 24);
+//   label.fillScreen(TFT_BLACK);
+//   label.setFreeFont(&FreeSans9pt7b);
+//   label.drawString("21.5 C", 4, 4);
+//   label.pushSprite(tft, 10, 100);
+//
+// Pixels are stored in panel byte order, so they go out without conversion.
+// pushSprite() also works into the driver's canvas() or into another sprite.
+//
+// Sprites can also be palettized: call setColorDepth(1, 2, 4 or 8) before
+// createSprite() and each pixel is stored as a palette index. A full-screen
+// 4-bpp sprite takes 75 KB instead of 300 KB. Drawing maps each color to
+// the nearest palette entry (at 1 bpp: entry 0 for its own color, entry 1
+// for any other); pushSprite() expands the indices through the palette while
+// filling the target's line buffers.
+//
+//   ILI9486_Sprite screen;
+//   screen.setColorDepth(4);            // Default 16-color palette
+//   screen.createSprite(480, 320);
+class ILI9486_Sprite : public ILI9486_RamCanvas {
+public:
+  ILI9486_Sprite() : _bpp(16), _frame(nullptr), _palette(nullptr) {}
+  ~ILI9486_Sprite() { deleteSprite(); }
+  ILI9486_Sprite(const ILI9486_Sprite &) = delete;
+  ILI9486_Sprite &operator=(const ILI9486_Sprite &) = delete;
+
+  // Bits per pixel for the next createSprite(): 16 (RGB565, default) or
+  // 1, 2, 4 or 8 (palette indices). Returns false for other values.
+  bool setColorDepth(uint8_t bpp) {
+    if (bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8 && bpp != 16) return false;
+    _bpp = bpp;
+    return true;
+  }
+  uint8_t getColorDepth() { return _bpp; }
+
+  // Allocate a w x h sprite (PSRAM when available), cleared to black, or to
+  // palette entry 0 when palettized. Returns false if out of memory.
+  bool createSprite(uint16_t w, uint16_t h) {
+    deleteSprite();
+    size_t bytes = (((uint32_t)w * _bpp + 7) / 8) * h;
+    if (_bpp < 16) {
+      _palette = (uint16_t *)malloc(sizeof(uint16_t) << _bpp);
+      if (!_palette) return false;
+      defaultPalette();
+    }
+    _frame = (uint8_t *)ili9486_frame_alloc(bytes);
+    if (!_frame) {
+      deleteSprite();
+      return false;
+    }
+    memset(_frame, 0, bytes);
+    setDepth(_bpp, _palette);
+    setBuffer(_frame, w, h);
+    return true;
+  }
+
+  void deleteSprite() {
+    ili9486_dma_free(_frame);
+    _frame = nullptr;
+    free(_palette);
+    _palette = nullptr;
+    setBuffer(nullptr, 0, 0);
+  }
+  bool created() { return _frame != nullptr; }
+
+  // Palette of a palettized sprite (created first). Entries that are not
+  // set keep the default palette: black/white at 1 bpp, a grey ramp at 2,
+  // the TFT_ colors at 4 and RGB332 at 8.
+  void setPaletteColor(uint8_t index, uint16_t color) {
+    if (!_palette || index >= (1 << depth())) return;
+    _palette[index] = color;
+    paletteChanged();
+  }
+  void createPalette(const uint16_t *colors, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+      setPaletteColor(i, colors[i]);
+    }
+  }
+  uint16_t getPaletteColor(uint8_t index) {
+    return _palette && index < (1 << depth()) ? _palette[index] : 0;
+  }
+
+  // Palette index at (x, y) of a palettized sprite
+  uint8_t readIndex(uint16_t x, uint16_t y) {
+    if (!created() || depth() == 16 || x >= width() || y >= height()) return 0;
+    uint8_t bpp = depth();
+    uint32_t bit = (uint32_t)x * bpp;
+    uint8_t b = _frame[(uint32_t)y * stride() + (bit >> 3)];
+    return (b >> (8 - bpp - (bit & 7))) & ((1 << bpp) - 1);
+  }
+
+  // Copy the sprite to (x, y) on the target, clipped to its edges
+  template <class Display>
+  void pushSprite(Display &tft, int16_t x, int16_t y);
+
+  // As above, but pixels of the transparent color are skipped. Each run of
+  // visible pixels in a row is sent as its own window.
+  template <class Display>
+  void pushSprite(Display &tft, int16_t x, int16_t y, uint16_t transparent);
+
+  // The rest of what ILI9486_Scene expects of a display. A sprite is drawn
+  // in place, so there is nothing to wait for and nothing is recorded.
+  ILI9486_Fence pushImageDMA(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t *data) {
+    pushImage(x, y, w, h, data);
+    return 0;
+  }
+  void waitDMA() {}
+  void waitDMA(ILI9486_Fence) {}
+  bool recording() { return false; }
+  void endDeferred() {}
+
+private:
+  uint8_t _bpp;             // Depth for the next createSprite()
+  uint8_t *_frame;
+  uint16_t *_palette;       // 1 << depth() entries when palettized
+
+  const uint16_t *rowPixels(uint16_t row, uint16_t col) {
+    return (const uint16_t *)(_frame + ((uint32_t)row * width() + col) * 2);
+  }
+
+  // Clip the sprite against the target. Returns false if nothing is visible.
+  template <class Display>
+  bool clip(Display &tft, int16_t &x, int16_t &y, int16_t &sx, int16_t &sy, int16_t &w, int16_t &h) {
+    if (!created()) return false;
+    sx = 0;
+    sy = 0;
+    w = width();
+    h = height();
+    if (x < 0) { sx = -x; w += x; x = 0; }
+    if (y < 0) { sy = -y; h += y; y = 0; }
+    if (x + w > (int16_t)tft.width()) w = tft.width() - x;
+    if (y + h > (int16_t)tft.height()) h = tft.height() - y;
+    return w > 0 && h > 0;
+  }
+
+  void defaultPalette() {
+    static const uint16_t colors16[16] = {
+      TFT_BLACK, TFT_WHITE, TFT_RED, TFT_GREEN, TFT_BLUE, TFT_CYAN, TFT_MAGENTA, TFT_YELLOW,
+      TFT_ORANGE, TFT_GREENYELLOW, TFT_DARKGREY, TFT_LIGHTGREY,
+      0x000F, 0x03E0, 0x7800, 0x7BE0   // Navy, dark green, maroon, olive
+    };
+    static const uint16_t greys[4] = { TFT_BLACK, TFT_DARKGREY, TFT_LIGHTGREY, TFT_WHITE };
+    if (_bpp == 1) {
+      _palette[0] = TFT_BLACK;
+      _palette[1] = TFT_WHITE;
+    } else if (_bpp == 2) {
+      memcpy(_palette, greys, sizeof(greys));
+    } else if (_bpp == 4) {
+      memcpy(_palette, colors16, sizeof(colors16));
+    } else {
+      // RGB332: every index is a color, so arbitrary colors map closely
+      for (uint16_t i = 0; i < 256; i++) {
+        uint8_t r = i >> 5, g = (i >> 2) & 7, b = i & 3;
+        _palette[i] = ((r * 31 / 7) << 11) | ((g * 63 / 7) << 5) | (b * 31 / 3);
+      }
+    }
+  }
+};
+
+template <class Display>
+void ILI9486_Sprite::pushSprite(Display &tft, int16_t x, int16_t y) {
+  if (created() && depth() < 16) {
+    // Palette lookup happens while the target's line buffers are filled
+    tft.pushRows(x, y, width(), height(), [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+      readRow(dst, row, col, count);
+    });
+    return;
+  }
+  int16_t sx, sy, w, h;
+  if (!clip(tft, x, y, sx, sy, w, h)) return;
+
+  tft.startWrite();
+  tft.setWindow(x, y, x + w - 1, y + h - 1);
+  if (w == (int16_t)width()) {
+    // Whole rows are contiguous: one transfer
+    tft.pushPixels(rowPixels(sy, 0), (uint32_t)w * h, false);
+  } else {
+    for (int16_t r = 0; r < h; r++) {
+      tft.pushPixels(rowPixels(sy + r, sx), w, false);
+    }
+  }
+  tft.endWrite();
+}
+
+template <class Display>
+void ILI9486_Sprite::pushSprite(Display &tft, int16_t x, int16_t y, uint16_t transparent) {
+  int16_t sx, sy, w, h;
+  if (!clip(tft, x, y, sx, sy, w, h)) return;
+
+  if (depth() < 16) {
+    // Runs of indices whose palette color is not transparent
+    tft.startWrite();
+    for (int16_t r = 0; r < h; r++) {
+      int16_t i = 0;
+      while (i < w) {
+        while (i < w && _palette[readIndex(sx + i, sy + r)] == transparent) i++;
+        int16_t start = i;
+        while (i < w && _palette[readIndex(sx + i, sy + r)] != transparent) i++;
+        if (i > start) {
+          tft.pushRows(x + start, y + r, i - start, 1, [&](uint8_t *dst, uint16_t, uint16_t col, uint16_t count) {
+            readRow(dst, sy + r, sx + start + col, count);
+          });
+        }
+      }
+    }
+    tft.endWrite();
+    return;
+  }
+
+  uint8_t khi = transparent >> 8, klo = transparent & 0xFF;
+  tft.startWrite();
+  for (int16_t r = 0; r < h; r++) {
+    const uint8_t *src = (const uint8_t *)rowPixels(sy + r, sx);
+    int16_t i = 0;
+    while (i < w) {
+      while (i < w && src[2 * i] == khi && src[2 * i + 1] == klo) i++;
+      int16_t start = i;
+      while (i < w && (src[2 * i] != khi || src[2 * i + 1] != klo)) i++;
+      if (i > start) {
+        tft.setWindow(x + start, y + r, x + i - 1, y + r);
+        tft.pushPixels((const uint16_t *)(src + 2 * start), i - start, false);
+      }
+    }
+  }
+  tft.endWrite();
+}
+
+#endif // ILI9486_SPRITE_H
@@ -0,0 +1,470 @@
+#ifndef ILI9486_WINDOW_H
+#define ILI9486_WINDOW_H
+
+#include "ILI9486_Display.h"
+
+// Most windows a manager holds
+#ifndef ILI9486_MAX_WINDOWS
+#define ILI9486_MAX_WINDOWS 8
+#endif
+
+// Most rectangles in a region (a window's visible part, an exposed area).
+// A region that runs out of room merges two of its rectangles into their
+// bounding box, so it never loses area; it may grow a little instead, which
+// at worst repaints a few pixels next to it.
+#ifndef ILI9486_REGION_RECTS
+#define ILI9486_REGION_RECTS 32
+#endif
+
+// Rectangle with inclusive bounds
+struct ILI9486_Rect {
+  int16_t x0, y0, x1, y1;
+};
+
+// Area made of non-overlapping rectangles (they may overlap once a region has
+// run out of room, see ILI9486_REGION_RECTS)
+class ILI9486_Region {
+public:
+  ILI9486_Region() : _count(0) {}
+  
+  void clear() { _count = 0; }
+  void set(const ILI9486_Rect &r) { _count = 0; add(r); }
+  void add(const ILI9486_Rect &r);       // r must not overlap the region
+  void subtract(const ILI9486_Rect &cut);
+  void subtract(const ILI9486_Region &cut);
+  bool contains(int16_t x, int16_t y) const;
+  
+  bool empty() const { return _count == 0; }
+  uint8_t count() const { return _count; }
+  const ILI9486_Rect &operator[](uint8_t i) const { return _rect[i]; }
+  
+private:
+  ILI9486_Rect _rect[ILI9486_REGION_RECTS];
+  uint8_t _count;
+  
+  void merge(const ILI9486_Rect &r);
+  static int32_t area(const ILI9486_Rect &r) { return (int32_t)(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1); }
+  static ILI9486_Rect box(const ILI9486_Rect &a, const ILI9486_Rect &b) {
+    return { a.x0 < b.x0 ? a.x0 : b.x0, a.y0 < b.y0 ? a.y0 : b.y0, a.x1 > b.x1 ? a.x1 : b.x1, a.y1 > b.y1 ? a.y1 : b.y1 };
+  }
+};
+
+inline void ILI9486_Region::add(const ILI9486_Rect &r) {
+  if (r.x0 > r.x1 || r.y0 > r.y1) return;
+  if (_count < ILI9486_REGION_RECTS) {
+    _rect[_count++] = r;
+  } else {
+    merge(r);
+  }
+}
+
+// Full region: of all rectangles and r, replace the two whose bounding box
+// adds least area (none for neighbours sharing a whole edge) by that box,
+// and drop the rectangles it now covers. The box may overlap others.
+inline void ILI9486_Region::merge(const ILI9486_Rect &r) {
+  auto at = [&](uint8_t i) -> const ILI9486_Rect & { return i < _count ? _rect[i] : r; };
+  uint8_t a = 0, b = 1;
+  int32_t best = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    for (uint8_t j = i + 1; j <= _count; j++) {
+      int32_t waste = area(box(at(i), at(j))) - area(at(i)) - area(at(j));
+      if ((i == 0 && j == 1) || waste < best) {
+        a = i;
+        b = j;
+        best = waste;
+      }
+    }
+  }
+  
+  ILI9486_Rect u = box(at(a), at(b));
+  if (b < _count) _rect[b] = r;
+  _rect[a] = u;
+  for (uint8_t i = 0; i < _count;) {
+    const ILI9486_Rect &c = _rect[i];
+    if (i != a && c.x0 >= u.x0 && c.x1 <= u.x1 && c.y0 >= u.y0 && c.y1 <= u.y1) {
+      _rect[i] = _rect[--_count];
+      if (a == _count) a = i;
+    } else {
+      i++;
+    }
+  }
+}
+
+// Replace each rectangle the cut overlaps by the up to four pieces around it:
+// full-width bands above and below, then the parts left and right of it.
+// Rectangles are visited from the end, so the pieces (and boxes merge()
+// makes when the region is full) are never cut again.
+inline void ILI9486_Region::subtract(const ILI9486_Rect &cut) {
+  if (cut.x0 > cut.x1 || cut.y0 > cut.y1) return;
+  for (uint8_t i = _count; i-- > 0;) {
+    if (i >= _count) continue;
+    ILI9486_Rect a = _rect[i];
+    if (a.x1 < cut.x0 || a.x0 > cut.x1 || a.y1 < cut.y0 || a.y0 > cut.y1) continue;
+    _rect[i] = _rect[--_count];
+    int16_t y0 = a.y0 > cut.y0 ? a.y0 : cut.y0;
+    int16_t y1 = a.y1 < cut.y1 ? a.y1 : cut.y1;
+    add({ a.x0, a.y0, a.x1, (int16_t)(cut.y0 - 1) });
+    add({ a.x0, (int16_t)(cut.y1 + 1), a.x1, a.y1 });
+    add({ a.x0, y0, (int16_t)(cut.x0 - 1), y1 });
+    add({ (int16_t)(cut.x1 + 1), y0, a.x1, y1 });
+  }
+}
+
+inline void ILI9486_Region::subtract(const ILI9486_Region &cut) {
+  for (uint8_t i = 0; i < cut._count && _count; i++) {
+    subtract(cut._rect[i]);
+  }
+}
+
+inline bool ILI9486_Region::contains(int16_t x, int16_t y) const {
+  for (uint8_t i = 0; i < _count; i++) {
+    const ILI9486_Rect &r = _rect[i];
+    if (x >= r.x0 && x <= r.x1 && y >= r.y0 && y <= r.y1) return true;
+  }
+  return false;
+}
+
+template <class Display>
+class ILI9486_WindowManager;
+
+// Drawing context of one window. Coordinates are relative to the window's
+// top-left corner, and everything is clipped to the part of the window that
+// is not covered by windows above it, so an app can draw whenever it likes
+// without damaging the others. All drawing and text functions of the
+// display are available; each window keeps its own font, colors and cursor.
+//
+// Blocks streamed with pushRows() are split along the visible region, so
+// while the window is partly covered a row may be asked for in pieces, and
+// not necessarily top to bottom.
+template <class Display>
+class ILI9486_Window : public ILI9486_GFX<ILI9486_Window<Display> > {
+public:
+  // Redraws the window's content; called whenever part of it is exposed
+  typedef void (*PaintFn)(ILI9486_Window &win, void *user);
+  
+  ILI9486_Window() : _tft(nullptr), _x(0), _y(0), _w(0), _h(0), _clip(&_visible), _paint(nullptr), _user(nullptr), _open(false) {}
+  
+  int16_t left() { return _x; }
+  int16_t top() { return _y; }
+  uint16_t width() { return _w; }
+  uint16_t height() { return _h; }
+  bool isOpen() { return _open; }
+  bool isVisible() { return _open && !_visible.empty(); }
+  const ILI9486_Region &visibleRegion() { return _visible; }   // Screen coordinates
+  
+  void startWrite() { _tft->startWrite(); }
+  void endWrite() { _tft->endWrite(); }
+  
+  void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+  void drawPixel(uint16_t x, uint16_t y, uint16_t color);
+  template <class RowFn>
+  void pushRows(int16_t x, int16_t y, int16_t w, int16_t h, RowFn renderRow);
+  
+private:
+  friend class ILI9486_WindowManager<Display>;
+  
+  Display *_tft;
+  int16_t _x, _y;
+  uint16_t _w, _h;
+  ILI9486_Region _visible;
+  const ILI9486_Region *_clip;    // _visible, or the exposed part while painting
+  PaintFn _paint;
+  void *_user;
+  bool _open;
+  
+  // Window-relative block to inclusive screen bounds. Coordinates are taken
+  // as signed, so a block can start left of or above the window.
+  ILI9486_Rect toScreen(int16_t x, int16_t y, int32_t w, int32_t h);
+};
+
+template <class Display>
+ILI9486_Rect ILI9486_Window<Display>::toScreen(int16_t x, int16_t y, int32_t w, int32_t h) {
+  int32_t x0 = (int32_t)_x + (x > 0 ? x : 0);
+  int32_t y0 = (int32_t)_y + (y > 0 ? y : 0);
+  int32_t x1 = (int32_t)_x + (x + w < (int32_t)_w ? x + w : (int32_t)_w) - 1;
+  int32_t y1 = (int32_t)_y + (y + h < (int32_t)_h ? y + h : (int32_t)_h) - 1;
+  if (x1 < x0 || y1 < y0) return { 0, 0, -1, -1 };
+  return { (int16_t)x0, (int16_t)y0, (int16_t)x1, (int16_t)y1 };
+}
+
+template <class Display>
+void ILI9486_Window<Display>::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+  ILI9486_Rect r = toScreen((int16_t)x, (int16_t)y, w, h);
+  if (r.x0 > r.x1) return;
+  for (uint8_t i = 0; i < _clip->count(); i++) {
+    const ILI9486_Rect &c = (*_clip)[i];
+    int16_t x0 = r.x0 > c.x0 ? r.x0 : c.x0, x1 = r.x1 < c.x1 ? r.x1 : c.x1;
+    int16_t y0 = r.y0 > c.y0 ? r.y0 : c.y0, y1 = r.y1 < c.y1 ? r.y1 : c.y1;
+    if (x0 <= x1 && y0 <= y1) _tft->fillRect(x0, y0, x1 - x0 + 1, y1 - y0 + 1, color);
+  }
+}
+
+template <class Display>
+void ILI9486_Window<Display>::drawPixel(uint16_t x, uint16_t y, uint16_t color) {
+  if ((int16_t)x < 0 || (int16_t)y < 0 || x >= _w || y >= _h) return;
+  int16_t sx = _x + x, sy = _y + y;
+  if (_clip->contains(sx, sy)) _tft->drawPixel(sx, sy, color);
+}
+
+// One block per visible rectangle it overlaps, with the row and column
+// offsets mapped back to the caller's block
+template <class Display>
+template <class RowFn>
+void ILI9486_Window<Display>::pushRows(int16_t x, int16_t y, int16_t w, int16_t h, RowFn renderRow) {
+  ILI9486_Rect r = toScreen(x, y, w, h);
+  if (r.x0 > r.x1) return;
+  int32_t bx = (int32_t)_x + x, by = (int32_t)_y + y;   // Block origin on screen
+  for (uint8_t i = 0; i < _clip->count(); i++) {
+    const ILI9486_Rect &c = (*_clip)[i];
+    int16_t x0 = r.x0 > c.x0 ? r.x0 : c.x0, x1 = r.x1 < c.x1 ? r.x1 : c.x1;
+    int16_t y0 = r.y0 > c.y0 ? r.y0 : c.y0, y1 = r.y1 < c.y1 ? r.y1 : c.y1;
+    if (x0 > x1 || y0 > y1) continue;
+    uint16_t row0 = y0 - by, col0 = x0 - bx;
+    _tft->pushRows(x0, y0, x1 - x0 + 1, y1 - y0 + 1, [&](uint8_t *dst, uint16_t row, uint16_t col, uint16_t count) {
+      renderRow(dst, row0 + row, col0 + col, count);
+    });
+  }
+}
+
+// Overlapping windows on one display. Each window is a drawing context
+// (ILI9486_Window) plus a paint callback that redraws its content. The
+// manager tracks which part of each window is visible; opening, closing,
+// moving, resizing, raising and lowering windows repaint only what became
+// visible - the exposed parts of the windows below and of the desktop, and
+// all of a window that moved or changed size.
+//
+//   void paintClock(ILI9486_Window<ILI9486_Display> &win, void *) {
+//     win.fillScreen(TFT_DARKGREY);
+//     win.setTextColor(TFT_WHITE, TFT_DARKGREY);
+//     win.drawString(clockText, 4, 4);
+//   }
+//
+//   ILI9486_WindowManager<ILI9486_Display> wm(tft, TFT_BLACK);
+//   int8_t clock = wm.open(10, 10, 200, 40, paintClock);
+//   int8_t log = wm.open(60, 30, 300, 200, paintLog);   // On top of clock
+//   wm.window(clock).drawString(clockText, 4, 4);      // Clipped by log
+//   wm.raise(clock);                                   // Repaints what log hid
+//   wm.move(log, 160, 100);                            // Repaints log and what it uncovered
+template <class Display>
+class ILI9486_WindowManager {
+public:
+  typedef ILI9486_Window<Display> Window;
+  
+  ILI9486_WindowManager(Display &tft, uint16_t bg = TFT_BLACK);
+  
+  // Open a window on top and paint it. Returns its id, or -1 if there is no
+  // room or paint is null.
+  int8_t open(int16_t x, int16_t y, uint16_t w, uint16_t h, typename Window::PaintFn paint, void *user = nullptr);
+  bool close(int8_t id);
+  
+  bool move(int8_t id, int16_t x, int16_t y);
+  bool resize(int8_t id, uint16_t w, uint16_t h);
+  bool raise(int8_t id);
+  bool lower(int8_t id);
+  
+  // Repaint a window (all of its visible part), or the whole screen
+  bool invalidate(int8_t id);
+  void redraw();
+  
+  // Desktop color, repainted at once where the desktop shows
+  void setBackground(uint16_t color);
+  
+  Window &window(int8_t id) { return _win[id]; }
+  int8_t windowAt(int16_t x, int16_t y);    // Topmost window at a screen point, or -1
+  uint8_t windowCount() { return _count; }
+  
+private:
+  Display &_tft;
+  Window _win[ILI9486_MAX_WINDOWS];
+  uint8_t _order[ILI9486_MAX_WINDOWS];  // Open window ids, bottom to top
+  uint8_t _count;
+  uint16_t _bg;
+  ILI9486_Region _desktop;              // Visible part of the desktop
+  ILI9486_Region _next, _exposed;       // Scratch for relayout()
+  
+  bool valid(int8_t id) { return id >= 0 && id < ILI9486_MAX_WINDOWS && _win[id]._open; }
+  ILI9486_Rect screen() { return { 0, 0, (int16_t)(_tft.width() - 1), (int16_t)(_tft.height() - 1) }; }
+  ILI9486_Rect onScreen(ILI9486_Rect r) {
+    ILI9486_Rect s = screen();
+    return { r.x0 > s.x0 ? r.x0 : s.x0, r.y0 > s.y0 ? r.y0 : s.y0, r.x1 < s.x1 ? r.x1 : s.x1, r.y1 < s.y1 ? r.y1 : s.y1 };
+  }
+  ILI9486_Rect bounds(const Window &w) { return { w._x, w._y, (int16_t)(w._x + w._w - 1), (int16_t)(w._y + w._h - 1) }; }
+  uint8_t position(int8_t id);
+  void relayout(int8_t fresh);
+  void paint(Window &w, const ILI9486_Region &area);
+  void paintDesktop(const ILI9486_Region &area);
+};
+
+template <class Display>
+ILI9486_WindowManager<Display>::ILI9486_WindowManager(Display &tft, uint16_t bg) : _tft(tft), _count(0), _bg(bg) {
+  for (uint8_t i = 0; i < ILI9486_MAX_WINDOWS; i++) {
+    _win[i]._tft = &tft;
+  }
+}
+
+template <class Display>
+int8_t ILI9486_WindowManager<Display>::open(int16_t x, int16_t y, uint16_t w, uint16_t h, typename Window::PaintFn paint, void *user) {
+  if (!paint) return -1;
+  int8_t id = 0;
+  while (id < ILI9486_MAX_WINDOWS && _win[id]._open) id++;
+  if (id == ILI9486_MAX_WINDOWS) return -1;
+  
+  Window &win = _win[id];
+  win._x = x;
+  win._y = y;
+  win._w = w;
+  win._h = h;
+  win._paint = paint;
+  win._user = user;
+  win._visible.clear();
+  win._open = true;
+  _order[_count++] = id;
+  relayout(id);
+  return id;
+}
+
+template <class Display>
+bool ILI9486_WindowManager<Display>::close(int8_t id) {
+  if (!valid(id)) return false;
+  uint8_t k = position(id);
+  memmove(&_order[k], &_order[k + 1], _count - k - 1);
+  _count--;
+  _win[id]._open = false;
+  _win[id]._visible.clear();
+  relayout(-1);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_WindowManager<Display>::move(int8_t id, int16_t x, int16_t y) {
+  if (!valid(id)) return false;
+  if (_win[id]._x == x && _win[id]._y == y) return true;
+  _win[id]._x = x;
+  _win[id]._y = y;
+  relayout(id);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_WindowManager<Display>::resize(int8_t id, uint16_t w, uint16_t h) {
+  if (!valid(id)) return false;
+  if (_win[id]._w == w && _win[id]._h == h) return true;
+  _win[id]._w = w;
+  _win[id]._h = h;
+  relayout(id);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_WindowManager<Display>::raise(int8_t id) {
+  if (!valid(id)) return false;
+  uint8_t k = position(id);
+  if (k == _count - 1) return true;
+  memmove(&_order[k], &_order[k + 1], _count - k - 1);
+  _order[_count - 1] = id;
+  relayout(-1);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_WindowManager<Display>::lower(int8_t id) {
+  if (!valid(id)) return false;
+  uint8_t k = position(id);
+  if (k == 0) return true;
+  memmove(&_order[1], &_order[0], k);
+  _order[0] = id;
+  relayout(-1);
+  return true;
+}
+
+template <class Display>
+bool ILI9486_WindowManager<Display>::invalidate(int8_t id) {
+  if (!valid(id)) return false;
+  paint(_win[id], _win[id]._visible);
+  return true;
+}
+
+template <class Display>
+void ILI9486_WindowManager<Display>::redraw() {
+  relayout(-1);
+  for (uint8_t k = 0; k < _count; k++) {
+    Window &w = _win[_order[k]];
+    paint(w, w._visible);
+  }
+  paintDesktop(_desktop);
+}
+
+template <class Display>
+void ILI9486_WindowManager<Display>::setBackground(uint16_t color) {
+  _bg = color;
+  relayout(-1);
+  paintDesktop(_desktop);
+}
+
+template <class Display>
+int8_t ILI9486_WindowManager<Display>::windowAt(int16_t x, int16_t y) {
+  for (uint8_t k = _count; k-- > 0;) {
+    const Window &w = _win[_order[k]];
+    if (x >= w._x && y >= w._y && x < w._x + w._w && y < w._y + w._h) return _order[k];
+  }
+  return -1;
+}
+
+template <class Display>
+uint8_t ILI9486_WindowManager<Display>::position(int8_t id) {
+  uint8_t k = 0;
+  while (_order[k] != id) k++;
+  return k;
+}
+
+// Recompute every visible region after a change and paint what each window
+// (and the desktop) shows now but did not before. The fresh window's
+// content is not on screen anywhere yet, so all of its visible part is
+// painted.
+template <class Display>
+void ILI9486_WindowManager<Display>::relayout(int8_t fresh) {
+  _tft.startWrite();
+  for (uint8_t k = 0; k < _count; k++) {
+    Window &w = _win[_order[k]];
+    _next.set(onScreen(bounds(w)));
+    for (uint8_t j = k + 1; j < _count; j++) {
+      _next.subtract(bounds(_win[_order[j]]));
+    }
+    _exposed = _next;
+    if (_order[k] != fresh) _exposed.subtract(w._visible);
+    w._visible = _next;
+    paint(w, _exposed);
+  }
+  
+  _next.set(screen());
+  for (uint8_t k = 0; k < _count; k++) {
+    _next.subtract(bounds(_win[_order[k]]));
+  }
+  _exposed = _next;
+  _exposed.subtract(_desktop);
+  _desktop = _next;
+  paintDesktop(_exposed);
+  _tft.endWrite();
+}
+
+template <class Display>
+void ILI9486_WindowManager<Display>::paint(Window &w, const ILI9486_Region &area) {
+  if (area.empty()) return;
+  _tft.startWrite();
+  w._clip = &area;
+  w._paint(w, w._user);
+  w._clip = &w._visible;
+  _tft.endWrite();
+}
+
+template <class Display>
+void ILI9486_WindowManager<Display>::paintDesktop(const ILI9486_Region &area) {
+  _tft.startWrite();
+  for (uint8_t i = 0; i < area.count(); i++) {
+    const ILI9486_Rect &r = area[i];
+    _tft.fillRect(r.x0, r.y0, r.x1 - r.x0 + 1, r.y1 - r.y0 + 1, _bg);
+  }
+  _tft.endWrite();
+}
+
+#endif // ILI9486_WINDOW_H
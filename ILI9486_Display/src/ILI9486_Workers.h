@@ -0,0 +1,227 @@
+#ifndef ILI9486_WORKERS_H
+#define ILI9486_WORKERS_H
+
+#include <Arduino.h>
+
+// Worker threads are on by default on desktop hosts. Arduino builds opt in
+// with -DILI9486_THREADS=1 (or a #define before the first include), which
+// only makes sense on dual-core ESP32s; that keeps <thread> and the worker
+// state out of sketches that never call setRenderThreads(). Without threads
+// the band scheduler below still works, with the calling thread rendering
+// every band.
+#ifndef ILI9486_THREADS
+#if !defined(ARDUINO)
+#define ILI9486_THREADS 1
+#else
+#define ILI9486_THREADS 0
+#endif
+#endif
+
+// Most worker threads renderList() can use. Each needs a strip of its own.
+#ifndef ILI9486_MAX_RENDER_THREADS
+#define ILI9486_MAX_RENDER_THREADS 3
+#endif
+
+// Stack of each worker on the ESP32 (bytes)
+#ifndef ILI9486_WORKER_STACK
+#define ILI9486_WORKER_STACK 4096
+#endif
+
+#if ILI9486_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#if defined(ARDUINO_ARCH_ESP32)
+#include "esp_pthread.h"
+#endif
+#endif
+
+// Band scheduler for ILI9486_Driver::renderList().
+//
+// A job is a run of bands rendered by fn(ctx, band) into a ring of `slots`
+// strips (band b goes into strip b % slots). The thread that owns the bus
+// consumes the bands in order: wait(b) returns once band b is rendered, and
+// release() hands the strip of a band that has left the wire to the next
+// band that uses it. Worker threads pick up released bands as soon as they
+// are allowed; the calling thread renders too while it waits, so with no
+// workers bands are rendered one at a time just ahead of the bus.
+//
+// Bands must not share state: each one only reads the job and writes its
+// own strip.
+class ILI9486_BandWorkers {
+public:
+  typedef void (*RenderFn)(void *ctx, uint16_t band);
+
+  ILI9486_BandWorkers() : _threads(0), _quit(false), _fn(nullptr), _ctx(nullptr), _bands(0), _claimed(0), _released(0), _slots(1) {}
+  ~ILI9486_BandWorkers() { start(0); }
+  ILI9486_BandWorkers(const ILI9486_BandWorkers &) = delete;
+  ILI9486_BandWorkers &operator=(const ILI9486_BandWorkers &) = delete;
+
+  // Run with this many worker threads (0 stops them). Returns false if
+  // threads are not available or could not be started.
+  bool start(uint8_t threads);
+  uint8_t threads() const { return _threads; }
+
+  // Start a job; bands below `released` may be rendered right away
+  void run(RenderFn fn, void *ctx, uint16_t bands, uint16_t slots, uint16_t released);
+  void release(uint16_t upTo);
+  void wait(uint16_t band);
+
+private:
+  static const uint8_t MAX_SLOTS = ILI9486_MAX_RENDER_THREADS + 2;
+
+  uint8_t _threads;
+  bool _quit;
+  RenderFn _fn;
+  void *_ctx;
+  uint16_t _bands;
+  uint16_t _claimed;        // Bands handed to a thread so far
+  uint16_t _released;       // Bands that may be rendered
+  uint16_t _slots;
+  int32_t _ready[MAX_SLOTS];  // Band last rendered into each strip
+#if ILI9486_THREADS
+  std::thread _worker[ILI9486_MAX_RENDER_THREADS];
+  std::mutex _lock;
+  std::condition_variable _changed;
+
+  void workerLoop();
+#endif
+
+  // Render band, lock held on entry and exit (released while rendering)
+  template <class Lock>
+  void renderOne(Lock &lock);
+};
+
+template <class Lock>
+void ILI9486_BandWorkers::renderOne(Lock &lock) {
+  uint16_t band = _claimed++;
+  lock.unlock();
+  _fn(_ctx, band);
+  lock.lock();
+  _ready[band % _slots] = band;
+#if ILI9486_THREADS
+  _changed.notify_all();
+#endif
+}
+
+#if ILI9486_THREADS
+
+inline bool ILI9486_BandWorkers::start(uint8_t threads) {
+  if (threads > ILI9486_MAX_RENDER_THREADS) return false;
+  if (_threads) {
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _quit = true;
+    }
+    _changed.notify_all();
+    for (uint8_t i = 0; i < _threads; i++) {
+      _worker[i].join();
+    }
+    _threads = 0;
+    _quit = false;
+  }
+
+#if defined(ARDUINO_ARCH_ESP32)
+  // Workers go to the other core, at the caller's priority
+  esp_pthread_cfg_t old = esp_pthread_get_default_config();
+  esp_pthread_get_cfg(&old);
+  esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+  cfg.stack_size = ILI9486_WORKER_STACK;
+  cfg.prio = uxTaskPriorityGet(NULL);
+  cfg.pin_to_core = xPortGetCoreID() ^ 1;
+  esp_pthread_set_cfg(&cfg);
+#endif
+  for (; _threads < threads; _threads++) {
+    _worker[_threads] = std::thread(&ILI9486_BandWorkers::workerLoop, this);
+  }
+#if defined(ARDUINO_ARCH_ESP32)
+  esp_pthread_set_cfg(&old);
+#endif
+  return true;
+}
+
+inline void ILI9486_BandWorkers::run(RenderFn fn, void *ctx, uint16_t bands, uint16_t slots, uint16_t released) {
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _fn = fn;
+    _ctx = ctx;
+    _bands = bands;
+    _slots = slots < MAX_SLOTS ? slots : MAX_SLOTS;
+    for (uint8_t i = 0; i < MAX_SLOTS; i++) {
+      _ready[i] = -1;
+    }
+    _claimed = 0;
+    _released = released < bands ? released : bands;
+  }
+  _changed.notify_all();
+}
+
+inline void ILI9486_BandWorkers::release(uint16_t upTo) {
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (upTo > _bands) upTo = _bands;
+    if (upTo <= _released) return;
+    _released = upTo;
+  }
+  _changed.notify_all();
+}
+
+inline void ILI9486_BandWorkers::wait(uint16_t band) {
+  std::unique_lock<std::mutex> lock(_lock);
+  while (_ready[band % _slots] != band) {
+    if (_claimed < _released) {
+      renderOne(lock);
+    } else {
+      _changed.wait(lock);
+    }
+  }
+}
+
+inline void ILI9486_BandWorkers::workerLoop() {
+  std::unique_lock<std::mutex> lock(_lock);
+  while (!_quit) {
+    if (_claimed < _released) {
+      renderOne(lock);
+    } else {
+      _changed.wait(lock);
+    }
+  }
+}
+
+#else
+
+// Single thread: bands are rendered by wait()
+struct ILI9486_NoLock {
+  void lock() {}
+  void unlock() {}
+};
+
+inline bool ILI9486_BandWorkers::start(uint8_t threads) { return threads == 0; }
+
+inline void ILI9486_BandWorkers::run(RenderFn fn, void *ctx, uint16_t bands, uint16_t slots, uint16_t released) {
+  _fn = fn;
+  _ctx = ctx;
+  _bands = bands;
+  _slots = slots < MAX_SLOTS ? slots : MAX_SLOTS;
+  for (uint8_t i = 0; i < MAX_SLOTS; i++) {
+    _ready[i] = -1;
+  }
+  _claimed = 0;
+  _released = released < bands ? released : bands;
+}
+
+inline void ILI9486_BandWorkers::release(uint16_t upTo) {
+  if (upTo > _bands) upTo = _bands;
+  if (upTo > _released) _released = upTo;
+}
+
+inline void ILI9486_BandWorkers::wait(uint16_t band) {
+  ILI9486_NoLock lock;
+  while (_ready[band % _slots] != band && _claimed < _released) {
+    renderOne(lock);
+  }
+}
+
+#endif // ILI9486_THREADS
+
+#endif // ILI9486_WORKERS_H